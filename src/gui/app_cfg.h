@@ -44,12 +44,25 @@
 //! \brief enable gui service
 #define USE_SERVICE_GUI_TGUI    ENABLED
 
+//! \brief record high-water mark and drops of the queues from DEF_QUEUE_EX
+#define USE_QUEUE_STATISTICS    DISABLED
+
+//! \brief record how long each critical section masks the interrupts
+#define USE_ATOM_PROFILE        DISABLED
+
+//! \brief measure the hot paths of tgui with TGUI_TRACE_BEGIN / END
+#define USE_TGUI_TRACE          DISABLED
+
 /*============================ INCLUDES ======================================*/
 //! \brief import head files
 #include ".\utilities\compiler.h"
 #include ".\utilities\usebits.h"
 #include ".\utilities\tiny_fsm.h"
+#include ".\utilities\coroutine.h"
 #include ".\utilities\communicate.h"
+#include ".\utilities\tx_pipe.h"
+#include ".\utilities\scheduler.h"
+#include ".\utilities\timer_wheel.h"
 #include ".\utilities\template\template.h"
 
 /*============================ MACROFIED FUNCTIONS ===========================*/
@@ -0,0 +1,470 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*============================ INCLUDES ======================================*/
+#include ".\app_cfg.h"
+
+#if USE_SERVICE_GUI_TGUI == ENABLED
+#include "..\interface.h"
+#include "..\grid.h"
+
+/*============================ MACROS ========================================*/
+#define this                            (*ptThis)
+
+//! \name request status
+//! @{
+#define GDC_REQUEST_IDLE                0   //!< complete or never submitted
+#define GDC_REQUEST_FILLING             1   //!< parameters are being set
+#define GDC_REQUEST_QUEUED              2   //!< waiting for gdc_async_task()
+//! @}
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+
+//! \name operation
+//! @{
+typedef enum {
+    GDC_OP_SET_GRID     = 0,
+    GDC_OP_GET_GRID,
+    GDC_OP_SAVE_CURRENT,
+    GDC_OP_RESUME,
+    GDC_OP_SET_BRUSH,
+    GDC_OP_CLEAR,
+    GDC_OP_PRINT,
+    GDC_OP_SCROLL,
+    GDC_OP_DRAW,
+} em_gdc_op_t;
+//! @}
+
+//! \name asynchronous request of a grid drawing context
+//! @{
+typedef struct __gdc_request CLASS(gdc_request_t);
+struct __gdc_request {
+    CLASS(gdc_request_t)    *ptNext;        //!< next request in the queue
+    const i_gdc_t           *ptGDC;         //!< target drawing context
+    DELEGATE_HANDLE         *ptHandler;     //!< completion handler
+    union {
+        grid_t              tGrid;
+        grid_t              *ptGrid;
+        grid_brush_t        tBrush;
+        struct {
+            uint8_t         *pchString;
+            uint_fast16_t   hwSize;
+        } Print;
+        struct {
+            grid_rect_t     tRegion;
+            int_fast8_t     chOffset;
+        } Scroll;
+        struct {
+            const grid_draw_t *ptCommands;
+            uint_fast16_t   hwCount;
+        } Draw;
+    } Param;                                //!< parameters of the operation
+    uint8_t                 chOperation;    //!< em_gdc_op_t
+    volatile uint8_t        chStatus;       //!< request status
+    int8_t                  chResult;       //!< result of the last operation
+};
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+//! requests in submitting order, the head one is running
+static CLASS(gdc_request_t) *s_ptHead = NULL;
+static CLASS(gdc_request_t) *s_ptTail = NULL;
+
+/*============================ PROTOTYPES ====================================*/
+/*============================ IMPLEMENTATION ================================*/
+
+/*! \brief check whether a request is in the queue, it does not depend on
+ *!        the status which is garbage before the first initialization
+ *! \param ptThis request object
+ *! \retval true the request is queued
+ *! \retval false the request is not queued
+ */
+static bool gdc_request_is_queued(CLASS(gdc_request_t) *ptThis)
+{
+    bool bQueued = false;
+
+    SAFE_ATOM_CODE(
+        CLASS(gdc_request_t) *ptItem = s_ptHead;
+        for (; NULL != ptItem; ptItem = ptItem->ptNext) {
+            if (ptItem == ptThis) {
+                bQueued = true;
+                break;
+            }
+        }
+    )
+
+    return bQueued;
+}
+
+/*! \brief initialize a request
+ *! \param ptRequest request object
+ *! \param ptGDC the grid drawing context it works on
+ *! \param ptHandler completion handler, it is called once with the request 
+ *!        as pParam when an operation is complete, NULL for polling
+ *!        gdc_request_get_result() only
+ *! \return the request object, NULL for invalid parameter or the request is
+ *!         not complete yet
+ */
+gdc_request_t *gdc_request_init(
+    gdc_request_t *ptRequest, const i_gdc_t *ptGDC, DELEGATE_HANDLE *ptHandler)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if ((NULL == ptRequest) || (NULL == ptGDC)) {
+        return NULL;
+    } else if (gdc_request_is_queued(ptThis)) {
+        return NULL;
+    }
+
+    this.ptNext = NULL;
+    this.ptGDC = ptGDC;
+    this.ptHandler = ptHandler;
+    this.chStatus = GDC_REQUEST_IDLE;
+    this.chResult = fsm_rt_cpl;
+
+    return ptRequest;
+}
+
+/*! \brief get the result of the last operation submitted with a request
+ *! \param ptRequest request object
+ *! \retval fsm_rt_on_going the operation is not complete yet
+ *! \retval fsm_rt_cpl the operation is complete
+ *! \retval fsm_rt_err the operation failed or invalid parameter
+ */
+fsm_rt_t gdc_request_get_result(gdc_request_t *ptRequest)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if (NULL == ptRequest) {
+        return fsm_rt_err;
+    } else if (GDC_REQUEST_IDLE != this.chStatus) {
+        return fsm_rt_on_going;
+    }
+
+    return (fsm_rt_t)this.chResult;
+}
+
+/*! \brief take a complete request for setting new parameters
+ *! \param ptThis request object
+ *! \retval true the request is taken
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+static bool gdc_request_take(CLASS(gdc_request_t) *ptThis)
+{
+    bool bTaken = false;
+
+    if ((NULL == ptThis) || (NULL == this.ptGDC)) {
+        return false;
+    }
+
+    SAFE_ATOM_CODE(
+        if (GDC_REQUEST_IDLE == this.chStatus) {
+            this.chStatus = GDC_REQUEST_FILLING;
+            bTaken = true;
+        }
+    )
+
+    return bTaken;
+}
+
+/*! \brief append a taken request to the queue
+ *! \param ptThis request object
+ *! \param chOperation em_gdc_op_t
+ *! \return true
+ */
+static bool gdc_request_queue(CLASS(gdc_request_t) *ptThis, uint8_t chOperation)
+{
+    this.chOperation = chOperation;
+    this.ptNext = NULL;
+
+    SAFE_ATOM_CODE(
+        if (NULL == s_ptTail) {
+            s_ptHead = ptThis;
+        } else {
+            s_ptTail->ptNext = ptThis;
+        }
+        s_ptTail = ptThis;
+        this.chStatus = GDC_REQUEST_QUEUED;
+    )
+
+    return true;
+}
+
+/*! \brief submit an operation to set current cursor position
+ *! \param ptRequest request object
+ *! \param tGrid cursor position
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+bool gdc_submit_set_grid(gdc_request_t *ptRequest, grid_t tGrid)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if (!gdc_request_take(ptThis)) {
+        return false;
+    }
+    this.Param.tGrid = tGrid;
+
+    return gdc_request_queue(ptThis, GDC_OP_SET_GRID);
+}
+
+/*! \brief submit an operation to get current cursor position
+ *! \param ptRequest request object
+ *! \param ptGrid buffer of the position, it should be kept until complete
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+bool gdc_submit_get_grid(gdc_request_t *ptRequest, grid_t *ptGrid)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if ((NULL == ptGrid) || !gdc_request_take(ptThis)) {
+        return false;
+    }
+    this.Param.ptGrid = ptGrid;
+
+    return gdc_request_queue(ptThis, GDC_OP_GET_GRID);
+}
+
+/*! \brief submit an operation to save current cursor position
+ *! \param ptRequest request object
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+bool gdc_submit_save_current(gdc_request_t *ptRequest)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if (!gdc_request_take(ptThis)) {
+        return false;
+    }
+
+    return gdc_request_queue(ptThis, GDC_OP_SAVE_CURRENT);
+}
+
+/*! \brief submit an operation to resume current cursor position
+ *! \param ptRequest request object
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+bool gdc_submit_resume(gdc_request_t *ptRequest)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if (!gdc_request_take(ptThis)) {
+        return false;
+    }
+
+    return gdc_request_queue(ptThis, GDC_OP_RESUME);
+}
+
+/*! \brief submit an operation to set display attribute
+ *! \param ptRequest request object
+ *! \param tBrush display attribute
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+bool gdc_submit_set_brush(gdc_request_t *ptRequest, grid_brush_t tBrush)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if (!gdc_request_take(ptThis)) {
+        return false;
+    }
+    this.Param.tBrush = tBrush;
+
+    return gdc_request_queue(ptThis, GDC_OP_SET_BRUSH);
+}
+
+/*! \brief submit an operation to clear the screen
+ *! \param ptRequest request object
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+bool gdc_submit_clear(gdc_request_t *ptRequest)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if (!gdc_request_take(ptThis)) {
+        return false;
+    }
+
+    return gdc_request_queue(ptThis, GDC_OP_CLEAR);
+}
+
+/*! \brief submit an operation to print a string at the cursor
+ *! \param ptRequest request object
+ *! \param pchString string buffer, it should be kept until complete
+ *! \param hwSize string length
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+bool gdc_submit_print(
+    gdc_request_t *ptRequest, uint8_t *pchString, uint_fast16_t hwSize)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if (!gdc_request_take(ptThis)) {
+        return false;
+    }
+    this.Param.Print.pchString = pchString;
+    this.Param.Print.hwSize = hwSize;
+
+    return gdc_request_queue(ptThis, GDC_OP_PRINT);
+}
+
+/*! \brief submit an operation to scroll full-width rows
+ *! \param ptRequest request object
+ *! \param tRegion rows to scroll
+ *! \param chOffset content movement along y
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter, the request is not complete yet or the
+ *!         grid drawing context cannot scroll
+ */
+bool gdc_submit_scroll(
+    gdc_request_t *ptRequest, grid_rect_t tRegion, int_fast8_t chOffset)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if ((NULL == ptRequest) || (NULL == this.ptGDC) || (NULL == this.ptGDC->Scroll)) {
+        //! the operation is optional
+        return false;
+    } else if (!gdc_request_take(ptThis)) {
+        return false;
+    }
+    this.Param.Scroll.tRegion = tRegion;
+    this.Param.Scroll.chOffset = chOffset;
+
+    return gdc_request_queue(ptThis, GDC_OP_SCROLL);
+}
+
+/*! \brief submit an operation to execute a batch of draw commands
+ *! \param ptRequest request object
+ *! \param ptCommands command array, it should be kept until complete
+ *! \param hwCount number of commands
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter, the request is not complete yet or the
+ *!         grid drawing context cannot draw batches
+ */
+bool gdc_submit_draw(
+    gdc_request_t *ptRequest, const grid_draw_t *ptCommands, uint_fast16_t hwCount)
+{
+    CLASS(gdc_request_t) *ptThis = (CLASS(gdc_request_t) *)ptRequest;
+
+    if ((NULL == ptRequest) || (NULL == this.ptGDC) || (NULL == this.ptGDC->Draw)) {
+        //! the operation is optional
+        return false;
+    } else if (!gdc_request_take(ptThis)) {
+        return false;
+    }
+    this.Param.Draw.ptCommands = ptCommands;
+    this.Param.Draw.hwCount = hwCount;
+
+    return gdc_request_queue(ptThis, GDC_OP_DRAW);
+}
+
+/*! \brief call the operation of a request once
+ *! \param ptThis request object
+ *! \return the result of the operation
+ */
+static fsm_rt_t gdc_request_run(CLASS(gdc_request_t) *ptThis)
+{
+    const i_gdc_t *ptGDC = this.ptGDC;
+
+    switch (this.chOperation) {
+        case GDC_OP_SET_GRID:
+            return ptGDC->Position.Set(this.Param.tGrid);
+        case GDC_OP_GET_GRID:
+            return ptGDC->Position.Get(this.Param.ptGrid);
+        case GDC_OP_SAVE_CURRENT:
+            return ptGDC->Position.SaveCurrent();
+        case GDC_OP_RESUME:
+            return ptGDC->Position.Resume();
+        case GDC_OP_SET_BRUSH:
+            return ptGDC->Color.Set(this.Param.tBrush);
+        case GDC_OP_CLEAR:
+            return ptGDC->Clear();
+        case GDC_OP_PRINT:
+            return ptGDC->Print(this.Param.Print.pchString, this.Param.Print.hwSize);
+        case GDC_OP_SCROLL:
+            return ptGDC->Scroll(this.Param.Scroll.tRegion, this.Param.Scroll.chOffset);
+        case GDC_OP_DRAW:
+            return ptGDC->Draw(this.Param.Draw.ptCommands, this.Param.Draw.hwCount);
+        default:
+            break;
+    }
+
+    return fsm_rt_err;
+}
+
+/*! \brief run the submitted operations in order, it could be the routine of a
+ *!        scheduler task
+ *! \param pArg not used
+ *! \retval fsm_rt_on_going some operations are not complete
+ *! \retval fsm_rt_cpl no operation is pending
+ */
+fsm_rt_t gdc_async_task(void *pArg)
+{
+    CLASS(gdc_request_t) *ptThis = s_ptHead;
+    fsm_rt_t tResult;
+
+    if (NULL == ptThis) {
+        return fsm_rt_cpl;
+    }
+
+    //! the arguments are kept in the request, so the operation is simply 
+    //! called again until it is complete
+    tResult = gdc_request_run(ptThis);
+    if (!IS_FSM_ERR(tResult) && (fsm_rt_cpl != tResult)) {
+        return fsm_rt_on_going;
+    }
+
+    SAFE_ATOM_CODE(
+        s_ptHead = this.ptNext;
+        if (NULL == s_ptHead) {
+            s_ptTail = NULL;
+        }
+        this.chResult = tResult;
+        //! the handler could submit the request again
+        this.chStatus = GDC_REQUEST_IDLE;
+    )
+
+    if (NULL != this.ptHandler) {
+        call_delegate_handler(this.ptHandler, ptThis);
+    }
+
+    return (NULL == s_ptHead) ? fsm_rt_cpl : fsm_rt_on_going;
+}
+
+/*! \brief check whether some operations are pending, it could be the wake 
+ *!        condition of the task running gdc_async_task()
+ *! \param pTarget not used
+ *! \retval true some operations are pending
+ *! \retval false no operation is pending
+ */
+bool gdc_async_is_pending(void *pTarget)
+{
+    return NULL != s_ptHead;
+}
+
+#endif  /* USE_SERVICE_GUI_TGUI == ENABLED */
+
+/* EOF */
@@ -0,0 +1,183 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __TGUI_GRID_ASYNC_H__
+#define __TGUI_GRID_ASYNC_H__
+
+/*============================ INCLUDES ======================================*/
+#include ".\app_cfg.h"
+
+#if USE_SERVICE_GUI_TGUI == ENABLED
+#include "..\interface.h"
+
+/*============================ MACROS ========================================*/
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+
+//! \name asynchronous request of a grid drawing context
+//! @{
+EXTERN_CLASS(gdc_request_t)
+    gdc_request_t           *ptNext;
+    const i_gdc_t           *ptGDC;
+    DELEGATE_HANDLE         *ptHandler;
+    union {
+        grid_t              tGrid;
+        grid_t              *ptGrid;
+        grid_brush_t        tBrush;
+        struct {
+            uint8_t         *pchString;
+            uint_fast16_t   hwSize;
+        } Print;
+        struct {
+            grid_rect_t     tRegion;
+            int_fast8_t     chOffset;
+        } Scroll;
+        struct {
+            const grid_draw_t *ptCommands;
+            uint_fast16_t   hwCount;
+        } Draw;
+    } Param;
+    uint8_t                 chOperation;
+    volatile uint8_t        chStatus;
+    int8_t                  chResult;
+END_EXTERN_CLASS(gdc_request_t)
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+/*! \brief initialize a request
+ *! \param ptRequest request object
+ *! \param ptGDC the grid drawing context it works on
+ *! \param ptHandler completion handler, it is called once with the request 
+ *!        as pParam when an operation is complete, NULL for polling
+ *!        gdc_request_get_result() only
+ *! \return the request object, NULL for invalid parameter or the request is
+ *!         not complete yet
+ */
+extern gdc_request_t *gdc_request_init(
+    gdc_request_t *ptRequest, const i_gdc_t *ptGDC, DELEGATE_HANDLE *ptHandler);
+
+/*! \brief get the result of the last operation submitted with a request
+ *! \param ptRequest request object
+ *! \retval fsm_rt_on_going the operation is not complete yet
+ *! \retval fsm_rt_cpl the operation is complete
+ *! \retval fsm_rt_err the operation failed or invalid parameter
+ */
+extern fsm_rt_t gdc_request_get_result(gdc_request_t *ptRequest);
+
+/*! \brief submit an operation to set current cursor position
+ *! \param ptRequest request object
+ *! \param tGrid cursor position
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+extern bool gdc_submit_set_grid(gdc_request_t *ptRequest, grid_t tGrid);
+
+/*! \brief submit an operation to get current cursor position
+ *! \param ptRequest request object
+ *! \param ptGrid buffer of the position, it should be kept until complete
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+extern bool gdc_submit_get_grid(gdc_request_t *ptRequest, grid_t *ptGrid);
+
+/*! \brief submit an operation to save current cursor position
+ *! \param ptRequest request object
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+extern bool gdc_submit_save_current(gdc_request_t *ptRequest);
+
+/*! \brief submit an operation to resume current cursor position
+ *! \param ptRequest request object
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+extern bool gdc_submit_resume(gdc_request_t *ptRequest);
+
+/*! \brief submit an operation to set display attribute
+ *! \param ptRequest request object
+ *! \param tBrush display attribute
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+extern bool gdc_submit_set_brush(gdc_request_t *ptRequest, grid_brush_t tBrush);
+
+/*! \brief submit an operation to clear the screen
+ *! \param ptRequest request object
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+extern bool gdc_submit_clear(gdc_request_t *ptRequest);
+
+/*! \brief submit an operation to print a string at the cursor
+ *! \param ptRequest request object
+ *! \param pchString string buffer, it should be kept until complete
+ *! \param hwSize string length
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter or the request is not complete yet
+ */
+extern bool gdc_submit_print(
+    gdc_request_t *ptRequest, uint8_t *pchString, uint_fast16_t hwSize);
+
+/*! \brief submit an operation to scroll full-width rows
+ *! \param ptRequest request object
+ *! \param tRegion rows to scroll
+ *! \param chOffset content movement along y
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter, the request is not complete yet or the
+ *!         grid drawing context cannot scroll
+ */
+extern bool gdc_submit_scroll(
+    gdc_request_t *ptRequest, grid_rect_t tRegion, int_fast8_t chOffset);
+
+/*! \brief submit an operation to execute a batch of draw commands
+ *! \param ptRequest request object
+ *! \param ptCommands command array, it should be kept until complete
+ *! \param hwCount number of commands
+ *! \retval true the operation is accepted
+ *! \retval false invalid parameter, the request is not complete yet or the
+ *!         grid drawing context cannot draw batches
+ */
+extern bool gdc_submit_draw(
+    gdc_request_t *ptRequest, const grid_draw_t *ptCommands, uint_fast16_t hwCount);
+
+/*! \brief run the submitted operations in order, it could be the routine of a
+ *!        scheduler task
+ *! \param pArg not used
+ *! \retval fsm_rt_on_going some operations are not complete
+ *! \retval fsm_rt_cpl no operation is pending
+ */
+extern fsm_rt_t gdc_async_task(void *pArg);
+
+/*! \brief check whether some operations are pending, it could be the wake 
+ *!        condition of the task running gdc_async_task()
+ *! \param pTarget not used
+ *! \retval true some operations are pending
+ *! \retval false no operation is pending
+ */
+extern bool gdc_async_is_pending(void *pTarget);
+
+#endif  /* USE_SERVICE_GUI_TGUI == ENABLED */
+
+#endif  /* __TGUI_GRID_ASYNC_H__ */
+
+/* EOF */
@@ -0,0 +1,46 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+//! \note do not move this pre-processor statement to other places
+#include "..\app_cfg.h"
+
+#ifndef __TGUI_GRID_CANVAS_APP_CFG_H__
+#define __TGUI_GRID_CANVAS_APP_CFG_H__
+
+/*============================ INCLUDES ======================================*/
+/*============================ MACROS ========================================*/
+//! \brief the longest text run a sink outputs with one Print
+#ifndef GRID_SINK_RUN_SIZE
+#   define GRID_SINK_RUN_SIZE           (32)
+#endif
+
+//! \brief unchanged cells a run reprints instead of moving the cursor over
+#ifndef GRID_SINK_BRIDGE_SIZE
+#   define GRID_SINK_BRIDGE_SIZE        (6)
+#endif
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+#endif  /* __TGUI_GRID_CANVAS_APP_CFG_H__ */
+
+/* EOF */
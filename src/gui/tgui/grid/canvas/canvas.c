@@ -0,0 +1,1355 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*============================ INCLUDES ======================================*/
+#include ".\app_cfg.h"
+
+#if USE_SERVICE_GUI_TGUI == ENABLED
+#include "..\interface.h"
+#include "..\grid.h"
+#include "..\..\trace\trace.h"
+
+/*============================ MACROS ========================================*/
+#define this                            (*ptThis)
+
+//! \name sink flag
+//! @{
+#define SINK_PEN_VALID                  _BV(0)      //!< tPen is the device cursor
+#define SINK_BRUSH_VALID                _BV(1)      //!< device brush is known
+//! @}
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+#define IS_BRUSH_EQUAL(__A, __B)                                            \
+            (   ((__A).tForeground.tValue == (__B).tForeground.tValue)      \
+            &&  ((__A).tBackground.tValue == (__B).tBackground.tValue))
+
+#define IS_CELL_EQUAL(__A, __B)                                             \
+            (   ((__A).chChar == (__B).chChar)                              \
+            &&  IS_BRUSH_EQUAL((__A).tBrush, (__B).tBrush))
+
+/*============================ TYPES =========================================*/
+
+//! \name grid layer
+//! @{
+typedef struct __grid_layer CLASS(grid_layer_t);
+struct __grid_layer {
+    CLASS(grid_layer_t)    *ptNext;         //!< next layer below
+    grid_cell_t            *ptCells;        //!< cell buffer
+    grid_rect_t             tRegion;        //!< position and size on the screen
+    grid_rect_t             tDamage;        //!< damaged area on the screen
+    uint_fast16_t           hwLines;        //!< number of lines in the cell buffer
+    uint_fast16_t           hwScroll;       //!< first line shown in the region
+    int_fast16_t            nScroll;        //!< content movement not shown yet
+    uint_fast8_t            chFlag;         //!< layer flag
+};
+//! @}
+
+//! \name grid screen
+//! @{
+typedef struct __grid_screen CLASS(grid_screen_t);
+struct __grid_screen {
+    CLASS(grid_layer_t)    *ptTop;          //!< top of the layer stack
+    grid_rect_t             tDamage;        //!< damage of removed layers
+};
+//! @}
+
+//! \brief read the cell to be shown at a specified screen position
+typedef grid_cell_t sink_source_t(void *pSource, grid_t tGrid);
+
+//! \name grid sink
+//! @{
+typedef struct __grid_sink CLASS(grid_sink_t);
+struct __grid_sink {
+    CLASS(grid_sink_t)     *ptNext;         //!< next sink of the same mirror
+    const i_gdc_t          *ptGDC;          //!< output device
+    grid_cell_t            *ptFront;        //!< what the device displays now
+    grid_rect_t             tDamage;        //!< area which may differ from the device
+    grid_rect_t             tWindow;        //!< area visited by current flush
+    grid_t                  tCursor;        //!< cell visited by current flush
+    grid_t                  tPen;           //!< device cursor position
+    grid_cell_t             tCell;          //!< brush and first cell of the run
+    uint8_t                 chRun[GRID_SINK_RUN_SIZE];  //!< text run being output
+    uint8_t                 chRunSize;      //!< characters in the run
+    uint_fast8_t            chFlag;
+    uint_fast8_t            chState;        //!< state of flush
+    uint_fast8_t            chOutput;       //!< state of cell output
+    uint_fast16_t           hwBudget;       //!< cells examined per call, 0 for no limit
+};
+//! @}
+
+//! \name grid compositor
+//! @{
+typedef struct __grid_compositor CLASS(grid_compositor_t);
+struct __grid_compositor {
+    CLASS(grid_sink_t)      tSink;          //!< output device and its front buffer
+    CLASS(grid_screen_t)   *ptScreen;       //!< screen being shown
+    CLASS(grid_screen_t)    tScreen;        //!< default screen
+    grid_cell_t             tBlank;         //!< cell shown where no layer covers
+    CLASS(grid_layer_t)    *ptScroll;       //!< layer being scrolled on the device
+    int_fast8_t             chScroll;       //!< movement being scrolled
+    uint_fast8_t            chState;
+};
+//! @}
+
+//! \name grid mirror
+//! @{
+typedef struct __grid_mirror CLASS(grid_mirror_t);
+struct __grid_mirror {
+    CLASS(grid_compositor_t) *ptSource;     //!< compositor rendering the canvas
+    CLASS(grid_sink_t)     *ptSinks;        //!< sinks showing the canvas
+};
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+/*============================ IMPLEMENTATION ================================*/
+
+static void layer_damage(CLASS(grid_layer_t) *ptThis, grid_rect_t tRect)
+{
+    this.tDamage = grid_rect_union(this.tDamage, tRect);
+}
+
+static grid_cell_t *layer_line(CLASS(grid_layer_t) *ptThis, uint_fast16_t hwLine)
+{
+    return &this.ptCells[hwLine * this.tRegion.chWidth];
+}
+
+static grid_cell_t *layer_cell(CLASS(grid_layer_t) *ptThis, grid_t tGrid)
+{
+    return &layer_line(ptThis, this.hwScroll + tGrid.chY)[tGrid.chX];
+}
+
+/*! \brief initialize a layer, all cells are transparent after initialization
+ *! \param ptLayer target layer
+ *! \param ptCells cell buffer with GRID_CELL_BUFFER_SIZE() cells
+ *! \param tRegion position and size of the layer on the screen
+ *! \param chFlag layer flag
+ *! \retval true layer is initialized
+ *! \retval false invalid parameter
+ */
+bool grid_layer_init(grid_layer_t *ptLayer, grid_cell_t *ptCells,
+                     grid_rect_t tRegion, uint_fast8_t chFlag)
+{
+    return grid_layer_init_ex(ptLayer, ptCells, tRegion, tRegion.chHeight, chFlag);
+}
+
+/*! \brief initialize a layer which holds more lines than its region shows,
+ *!        all cells are transparent after initialization
+ *! \param ptLayer target layer
+ *! \param ptCells cell buffer with GRID_CELL_BUFFER_SIZE(width, hwLines) cells
+ *! \param tRegion position and size of the layer on the screen
+ *! \param hwLines number of lines, it should not be less than the region height
+ *! \param chFlag layer flag
+ *! \retval true layer is initialized
+ *! \retval false invalid parameter
+ */
+bool grid_layer_init_ex(grid_layer_t *ptLayer, grid_cell_t *ptCells,
+        grid_rect_t tRegion, uint_fast16_t hwLines, uint_fast8_t chFlag)
+{
+    CLASS(grid_layer_t) *ptThis = (CLASS(grid_layer_t) *)ptLayer;
+    uint_fast16_t hwCount;
+
+    if ((NULL == ptLayer) || (NULL == ptCells) || grid_rect_is_empty(tRegion)) {
+        return false;
+    } else if (hwLines < (uint_fast16_t)tRegion.chHeight) {
+        return false;
+    }
+
+    this.ptNext = NULL;
+    this.ptCells = ptCells;
+    this.tRegion = tRegion;
+    this.tDamage = tRegion;
+    this.hwLines = hwLines;
+    this.hwScroll = 0;
+    this.nScroll = 0;
+    this.chFlag = chFlag;
+
+    hwCount = GRID_CELL_BUFFER_SIZE((uint_fast16_t)tRegion.chWidth, hwLines);
+    while (hwCount--) {
+        ptCells->chChar = GRID_CELL_TRANSPARENT;
+        ptCells->tBrush.tForeground.tValue = 0;
+        ptCells->tBrush.tBackground.tValue = 0;
+        ptCells++;
+    }
+
+    return true;
+}
+
+/*! \brief write a cell of a layer
+ *! \param ptLayer target layer
+ *! \param tGrid cell position inside the layer
+ *! \param tCell new cell value
+ *! \retval true cell is written
+ *! \retval false the position is outside the layer
+ */
+bool grid_layer_set_cell(grid_layer_t *ptLayer, grid_t tGrid, grid_cell_t tCell)
+{
+    CLASS(grid_layer_t) *ptThis = (CLASS(grid_layer_t) *)ptLayer;
+    grid_cell_t *ptCell;
+    grid_rect_t tRect;
+
+    if (NULL == ptLayer) {
+        return false;
+    } else if (     (tGrid.chX < 0) || (tGrid.chX >= this.tRegion.chWidth)
+                ||  (tGrid.chY < 0) || (tGrid.chY >= this.tRegion.chHeight)) {
+        return false;
+    }
+
+    ptCell = layer_cell(ptThis, tGrid);
+    if (!IS_CELL_EQUAL(*ptCell, tCell)) {
+        *ptCell = tCell;
+        tRect.chLeft = this.tRegion.chLeft + tGrid.chX;
+        tRect.chTop = this.tRegion.chTop + tGrid.chY;
+        tRect.chWidth = 1;
+        tRect.chHeight = 1;
+        layer_damage(ptThis, tRect);
+    }
+
+    return true;
+}
+
+/*! \brief read a cell of a layer
+ *! \param ptLayer target layer
+ *! \param tGrid cell position inside the layer
+ *! \param ptCell buffer for the cell value
+ *! \retval true cell is read
+ *! \retval false the position is outside the layer
+ */
+bool grid_layer_get_cell(grid_layer_t *ptLayer, grid_t tGrid, grid_cell_t *ptCell)
+{
+    CLASS(grid_layer_t) *ptThis = (CLASS(grid_layer_t) *)ptLayer;
+
+    if ((NULL == ptLayer) || (NULL == ptCell)) {
+        return false;
+    } else if (     (tGrid.chX < 0) || (tGrid.chX >= this.tRegion.chWidth)
+                ||  (tGrid.chY < 0) || (tGrid.chY >= this.tRegion.chHeight)) {
+        return false;
+    }
+
+    *ptCell = *layer_cell(ptThis, tGrid);
+
+    return true;
+}
+
+/*! \brief print a string into a layer, the string is cut at the layer edge
+ *! \param ptLayer target layer
+ *! \param tGrid start position inside the region of the layer
+ *! \param tBrush display attribute
+ *! \param pchString string buffer
+ *! \param hwSize string length
+ *! \return the number of characters written
+ */
+uint_fast16_t grid_layer_print(grid_layer_t *ptLayer, grid_t tGrid,
+        grid_brush_t tBrush, const uint8_t *pchString, uint_fast16_t hwSize)
+{
+    CLASS(grid_layer_t) *ptThis = (CLASS(grid_layer_t) *)ptLayer;
+
+    if (NULL == ptLayer) {
+        return 0;
+    } else if ((tGrid.chY < 0) || (tGrid.chY >= this.tRegion.chHeight)) {
+        return 0;
+    }
+
+    return grid_layer_print_line(   ptLayer, this.hwScroll + tGrid.chY, tGrid.chX,
+                                    tBrush, pchString, hwSize);
+}
+
+/*! \brief print a string into any line of a layer, no matter it is shown or
+ *!        not, the string is cut at the layer edge
+ *! \param ptLayer target layer
+ *! \param hwLine target line
+ *! \param chColumn start column
+ *! \param tBrush display attribute
+ *! \param pchString string buffer
+ *! \param hwSize string length
+ *! \return the number of characters written
+ */
+uint_fast16_t grid_layer_print_line(grid_layer_t *ptLayer,
+        uint_fast16_t hwLine, int_fast8_t chColumn, grid_brush_t tBrush,
+        const uint8_t *pchString, uint_fast16_t hwSize)
+{
+    CLASS(grid_layer_t) *ptThis = (CLASS(grid_layer_t) *)ptLayer;
+    grid_rect_t tRect;
+    grid_cell_t *ptCell;
+    uint_fast16_t hwCount;
+    int_fast8_t chFirst = -1, chLast = -1, chX;
+
+    if ((NULL == ptLayer) || (NULL == pchString) || (0 == hwSize)) {
+        return 0;
+    } else if (     (chColumn < 0) || (chColumn >= this.tRegion.chWidth)
+                ||  (hwLine >= this.hwLines)) {
+        return 0;
+    }
+
+    hwCount = MIN(hwSize, (uint_fast16_t)(this.tRegion.chWidth - chColumn));
+    ptCell = &layer_line(ptThis, hwLine)[chColumn];
+    for (chX = chColumn; chX < chColumn + (int_fast8_t)hwCount; chX++) {
+        grid_cell_t tCell;
+        tCell.chChar = *pchString++;
+        tCell.tBrush = tBrush;
+        if (!IS_CELL_EQUAL(*ptCell, tCell)) {
+            *ptCell = tCell;
+            if (chFirst < 0) {
+                chFirst = chX;
+            }
+            chLast = chX;
+        }
+        ptCell++;
+    }
+
+    //! only the lines shown in the region are damaged
+    if (    (chFirst >= 0)
+        &&  (hwLine >= this.hwScroll)
+        &&  (hwLine < this.hwScroll + this.tRegion.chHeight)) {
+        tRect.chLeft = this.tRegion.chLeft + chFirst;
+        tRect.chTop = this.tRegion.chTop + (int_fast8_t)(hwLine - this.hwScroll);
+        tRect.chWidth = chLast - chFirst + 1;
+        tRect.chHeight = 1;
+        layer_damage(ptThis, tRect);
+    }
+
+    return hwCount;
+}
+
+/*! \brief choose the first line shown in the region of a layer, the
+ *!        compositor scrolls the device instead of repainting the region
+ *!        when the layer is opaque and as wide as the screen
+ *! \param ptLayer target layer
+ *! \param hwLine first line to show
+ *! \retval true layer is panned
+ *! \retval false invalid parameter
+ */
+bool grid_layer_pan(grid_layer_t *ptLayer, uint_fast16_t hwLine)
+{
+    CLASS(grid_layer_t) *ptThis = (CLASS(grid_layer_t) *)ptLayer;
+
+    if (NULL == ptLayer) {
+        return false;
+    }
+
+    hwLine = MIN(hwLine, this.hwLines - this.tRegion.chHeight);
+    if (hwLine == this.hwScroll) {
+        return true;
+    }
+
+    //! showing later lines moves the content towards lower y
+    this.nScroll += (int_fast16_t)this.hwScroll - (int_fast16_t)hwLine;
+    this.hwScroll = hwLine;
+    layer_damage(ptThis, this.tRegion);
+
+    return true;
+}
+
+/*! \brief fill an area of a layer with the same cell
+ *! \param ptLayer target layer
+ *! \param tRect target area inside the layer
+ *! \param tCell cell value, use GRID_CELL_TRANSPARENT to clear the area
+ *! \retval true the area is filled
+ *! \retval false the area is outside the layer
+ */
+bool grid_layer_fill(grid_layer_t *ptLayer, grid_rect_t tRect, grid_cell_t tCell)
+{
+    CLASS(grid_layer_t) *ptThis = (CLASS(grid_layer_t) *)ptLayer;
+    grid_rect_t tLayer;
+    int_fast8_t chX, chY;
+
+    if (NULL == ptLayer) {
+        return false;
+    }
+    tLayer.chLeft = 0;
+    tLayer.chTop = 0;
+    tLayer.chWidth = this.tRegion.chWidth;
+    tLayer.chHeight = this.tRegion.chHeight;
+    if (!grid_rect_intersect(tLayer, tRect, &tRect)) {
+        return false;
+    }
+
+    for (chY = tRect.chTop; chY < tRect.chTop + tRect.chHeight; chY++) {
+        grid_t tGrid;
+        grid_cell_t *ptCell;
+        tGrid.chX = tRect.chLeft;
+        tGrid.chY = chY;
+        ptCell = layer_cell(ptThis, tGrid);
+        for (chX = 0; chX < tRect.chWidth; chX++) {
+            *ptCell++ = tCell;
+        }
+    }
+
+    tRect.chLeft += this.tRegion.chLeft;
+    tRect.chTop += this.tRegion.chTop;
+    layer_damage(ptThis, tRect);
+
+    return true;
+}
+
+/*! \brief move a layer to a new position on the screen
+ *! \param ptLayer target layer
+ *! \param tGrid new position of the top-left cell
+ *! \retval true layer is moved
+ *! \retval false invalid parameter
+ */
+bool grid_layer_move(grid_layer_t *ptLayer, grid_t tGrid)
+{
+    CLASS(grid_layer_t) *ptThis = (CLASS(grid_layer_t) *)ptLayer;
+
+    if (NULL == ptLayer) {
+        return false;
+    }
+
+    //! both the old and the new area should be composited again
+    layer_damage(ptThis, this.tRegion);
+    this.tRegion.__grid_t = tGrid;
+    layer_damage(ptThis, this.tRegion);
+
+    return true;
+}
+
+/*! \brief show or hide a layer
+ *! \param ptLayer target layer
+ *! \param bVisible true for showing the layer
+ *! \retval true layer visibility is set
+ *! \retval false invalid parameter
+ */
+bool grid_layer_show(grid_layer_t *ptLayer, bool bVisible)
+{
+    CLASS(grid_layer_t) *ptThis = (CLASS(grid_layer_t) *)ptLayer;
+
+    if (NULL == ptLayer) {
+        return false;
+    } else if (bVisible == !!(this.chFlag & GRID_LAYER_VISIBLE)) {
+        return true;
+    }
+
+    if (bVisible) {
+        this.chFlag |= GRID_LAYER_VISIBLE;
+    } else {
+        this.chFlag &= ~GRID_LAYER_VISIBLE;
+    }
+    layer_damage(ptThis, this.tRegion);
+
+    return true;
+}
+
+/*! \brief initialize a screen, a screen is a layer stack which could be
+ *!        updated in background and shown by a compositor later
+ *! \param ptScreen target screen
+ *! \retval true screen is initialized
+ *! \retval false invalid parameter
+ */
+bool grid_screen_init(grid_screen_t *ptScreen)
+{
+    CLASS(grid_screen_t) *ptThis = (CLASS(grid_screen_t) *)ptScreen;
+
+    if (NULL == ptScreen) {
+        return false;
+    }
+
+    this.ptTop = NULL;
+    this.tDamage.chLeft = 0;
+    this.tDamage.chTop = 0;
+    this.tDamage.chWidth = 0;
+    this.tDamage.chHeight = 0;
+
+    return true;
+}
+
+/*! \brief put a layer on top of the layer stack of a screen
+ *! \param ptScreen target screen
+ *! \param ptLayer target layer
+ *! \retval true layer is added
+ *! \retval false invalid parameter or the layer is already in the stack
+ */
+bool grid_screen_push_layer(grid_screen_t *ptScreen, grid_layer_t *ptLayer)
+{
+    CLASS(grid_screen_t) *ptThis = (CLASS(grid_screen_t) *)ptScreen;
+    CLASS(grid_layer_t) *ptLYR = (CLASS(grid_layer_t) *)ptLayer;
+    CLASS(grid_layer_t) *ptItem;
+
+    if ((NULL == ptScreen) || (NULL == ptLayer)) {
+        return false;
+    }
+    for (ptItem = this.ptTop; NULL != ptItem; ptItem = ptItem->ptNext) {
+        if (ptItem == ptLYR) {
+            return false;
+        }
+    }
+
+    ptLYR->ptNext = this.ptTop;
+    ptLYR->nScroll = 0;
+    this.ptTop = ptLYR;
+    layer_damage(ptLYR, ptLYR->tRegion);
+
+    return true;
+}
+
+/*! \brief remove a layer from the layer stack of a screen
+ *! \param ptScreen target screen
+ *! \param ptLayer target layer
+ *! \retval true layer is removed
+ *! \retval false the layer is not in the stack
+ */
+bool grid_screen_remove_layer(grid_screen_t *ptScreen, grid_layer_t *ptLayer)
+{
+    CLASS(grid_screen_t) *ptThis = (CLASS(grid_screen_t) *)ptScreen;
+    CLASS(grid_layer_t) *ptLYR = (CLASS(grid_layer_t) *)ptLayer;
+    CLASS(grid_layer_t) **pptItem;
+
+    if ((NULL == ptScreen) || (NULL == ptLayer)) {
+        return false;
+    }
+
+    for (pptItem = &this.ptTop; NULL != (*pptItem); pptItem = &((*pptItem)->ptNext)) {
+        if ((*pptItem) == ptLYR) {
+            (*pptItem) = ptLYR->ptNext;
+            ptLYR->ptNext = NULL;
+            //! the area below the layer is exposed
+            this.tDamage = grid_rect_union(this.tDamage, ptLYR->tRegion);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*! \brief the whole area of the device
+ */
+static grid_rect_t sink_screen(CLASS(grid_sink_t) *ptThis)
+{
+    grid_rect_t tScreen;
+
+    tScreen.chLeft = 0;
+    tScreen.chTop = 0;
+    tScreen.chWidth = this.ptGDC->Info.chWidth;
+    tScreen.chHeight = this.ptGDC->Info.chHeight;
+
+    return tScreen;
+}
+
+/*! \brief front buffer cell at a specified screen position
+ */
+static grid_cell_t *sink_front(CLASS(grid_sink_t) *ptThis, grid_t tGrid)
+{
+    return &this.ptFront[(uint_fast16_t)tGrid.chY * this.ptGDC->Info.chWidth + tGrid.chX];
+}
+
+/*! \brief mark an area which may differ from the device
+ */
+static void sink_damage(CLASS(grid_sink_t) *ptThis, grid_rect_t tRect)
+{
+    this.tDamage = grid_rect_union(this.tDamage, tRect);
+}
+
+/*! \brief forget what the device displays
+ */
+static void sink_invalidate(CLASS(grid_sink_t) *ptThis)
+{
+    grid_cell_t *ptCell = this.ptFront;
+    uint_fast16_t hwCount = GRID_CELL_BUFFER_SIZE(
+        (uint_fast16_t)this.ptGDC->Info.chWidth, this.ptGDC->Info.chHeight);
+
+    //! a transparent cell never equals to a composited cell
+    while (hwCount--) {
+        ptCell->chChar = GRID_CELL_TRANSPARENT;
+        ptCell++;
+    }
+
+    this.tDamage = sink_screen(ptThis);
+    this.chFlag = 0;
+}
+
+/*! \brief take the damage inside a limit as the window of a new flush
+ *! \retval true there is something to visit
+ *! \retval false nothing is damaged
+ */
+static bool sink_start(CLASS(grid_sink_t) *ptThis, grid_rect_t tLimit)
+{
+    bool bResult = false;
+
+    if (grid_rect_intersect(tLimit, sink_screen(ptThis), &tLimit)) {
+        bResult = grid_rect_intersect(tLimit, this.tDamage, &this.tWindow);
+    }
+    this.tDamage.chWidth = 0;
+    this.tDamage.chHeight = 0;
+    this.tCursor = this.tWindow.__grid_t;
+
+    return bResult;
+}
+
+/*! \brief move to next cell of the window
+ *! \retval true cursor moved
+ *! \retval false the whole window is visited
+ */
+static bool sink_next(CLASS(grid_sink_t) *ptThis)
+{
+    if (++this.tCursor.chX >= this.tWindow.chLeft + this.tWindow.chWidth) {
+        this.tCursor.chX = this.tWindow.chLeft;
+        if (++this.tCursor.chY >= this.tWindow.chTop + this.tWindow.chHeight) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*! \brief skip the cells of the run just output
+ *! \retval true cursor moved
+ *! \retval false the whole window is visited
+ */
+static bool sink_skip_run(CLASS(grid_sink_t) *ptThis)
+{
+    this.tCursor.chX += this.chRunSize - 1;
+
+    return sink_next(ptThis);
+}
+
+/*! \brief collect the cells following tCell with the same brush into a text
+ *!        run, short unchanged gaps are bridged as reprinting them costs less
+ *!        than a cursor movement
+ *! \return the number of cells examined
+ */
+static uint_fast8_t sink_build_run(
+    CLASS(grid_sink_t) *ptThis, sink_source_t *fnSource, void *pSource)
+{
+    int_fast8_t chRight = this.tWindow.chLeft + this.tWindow.chWidth;
+    grid_t tGrid = this.tCursor;
+    uint_fast8_t chSize = 1, chGap = 0;
+
+    this.chRun[0] = this.tCell.chChar;
+    this.chRunSize = 1;
+    while ((++tGrid.chX < chRight) && (chSize < GRID_SINK_RUN_SIZE)) {
+        grid_cell_t tCell = fnSource(pSource, tGrid);
+
+        if (!IS_BRUSH_EQUAL(tCell.tBrush, this.tCell.tBrush)) {
+            break;
+        }
+        this.chRun[chSize++] = tCell.chChar;
+        if (!IS_CELL_EQUAL(tCell, *sink_front(ptThis, tGrid))) {
+            //! a changed cell takes the gap before it into the run
+            this.chRunSize = chSize;
+            chGap = 0;
+        } else if (++chGap > GRID_SINK_BRIDGE_SIZE) {
+            break;
+        }
+    }
+
+    return chSize;
+}
+
+#define SINK_OUTPUT_SET_GRID            0
+#define SINK_OUTPUT_SET_BRUSH           1
+#define SINK_OUTPUT_PRINT               2
+#define SINK_OUTPUT_RESET_FSM()         do { this.chOutput = 0; } while (0)
+
+/*! \brief output the run at tCursor and record it in the front buffer
+ */
+static fsm_rt_t sink_output(CLASS(grid_sink_t) *ptThis)
+{
+    fsm_rt_t tFSM;
+
+    switch (this.chOutput) {
+        case SINK_OUTPUT_SET_GRID:
+            if (    !(this.chFlag & SINK_PEN_VALID)
+                ||  (this.tPen.chX != this.tCursor.chX)
+                ||  (this.tPen.chY != this.tCursor.chY)) {
+                tFSM = this.ptGDC->Position.Set(this.tCursor);
+                if (IS_FSM_ERR(tFSM)) {
+                    this.chFlag = 0;
+                    SINK_OUTPUT_RESET_FSM();
+                    return tFSM;
+                } else if (fsm_rt_cpl != tFSM) {
+                    break;
+                }
+                this.tPen = this.tCursor;
+                this.chFlag |= SINK_PEN_VALID;
+            }
+            this.chOutput = SINK_OUTPUT_SET_BRUSH;
+            //break;
+
+        case SINK_OUTPUT_SET_BRUSH: {
+            grid_brush_t tBrush = this.ptGDC->Color.Get();
+            if (    !(this.chFlag & SINK_BRUSH_VALID)
+                ||  (tBrush.tForeground.tValue != this.tCell.tBrush.tForeground.tValue)
+                ||  (tBrush.tBackground.tValue != this.tCell.tBrush.tBackground.tValue)) {
+                tFSM = this.ptGDC->Color.Set(this.tCell.tBrush);
+                if (IS_FSM_ERR(tFSM)) {
+                    this.chFlag = 0;
+                    SINK_OUTPUT_RESET_FSM();
+                    return tFSM;
+                } else if (fsm_rt_cpl != tFSM) {
+                    break;
+                }
+                this.chFlag |= SINK_BRUSH_VALID;
+            }
+            this.chOutput = SINK_OUTPUT_PRINT;
+        }
+            //break;
+
+        case SINK_OUTPUT_PRINT:
+            tFSM = this.ptGDC->Print(this.chRun, this.chRunSize);
+            if (IS_FSM_ERR(tFSM)) {
+                this.chFlag = 0;
+                SINK_OUTPUT_RESET_FSM();
+                return tFSM;
+            } else if (fsm_rt_cpl != tFSM) {
+                break;
+            } else {
+                grid_cell_t *ptFront = sink_front(ptThis, this.tCursor);
+                uint_fast8_t n;
+
+                for (n = 0; n < this.chRunSize; n++) {
+                    ptFront->chChar = this.chRun[n];
+                    ptFront->tBrush = this.tCell.tBrush;
+                    ptFront++;
+                }
+            }
+
+            //! the device cursor moves right after printing
+            this.tPen.chX += this.chRunSize;
+            if (this.tPen.chX >= this.ptGDC->Info.chWidth) {
+                this.chFlag &= ~SINK_PEN_VALID;
+            }
+            SINK_OUTPUT_RESET_FSM();
+            return fsm_rt_cpl;
+    }
+
+    return fsm_rt_on_going;
+}
+
+#define SINK_FLUSH_START                0
+#define SINK_FLUSH_DIFF                 1
+#define SINK_FLUSH_OUTPUT               2
+#define SINK_FLUSH_RESET_FSM()          do { this.chState = 0; } while (0)
+
+/*! \brief output the cells of a source which differ from what the device
+ *!        displays, cells sharing a brush are merged into text runs. It
+ *!        returns fsm_rt_on_going when the budget of this call is used up
+ *!        and continues from the cursor in the next call.
+ */
+static fsm_rt_t sink_flush(CLASS(grid_sink_t) *ptThis, grid_rect_t tLimit,
+                            sink_source_t *fnSource, void *pSource)
+{
+    uint_fast16_t hwWork = 0;
+    fsm_rt_t tFSM;
+
+    switch (this.chState) {
+        case SINK_FLUSH_START:
+            if (!sink_start(ptThis, tLimit)) {
+                return fsm_rt_cpl;
+            }
+            this.chState = SINK_FLUSH_DIFF;
+            //break;
+
+        case SINK_FLUSH_DIFF:
+            do {
+                if ((0 != this.hwBudget) && (hwWork++ >= this.hwBudget)) {
+                    return fsm_rt_on_going;
+                }
+                this.tCell = fnSource(pSource, this.tCursor);
+                if (!IS_CELL_EQUAL(this.tCell, *sink_front(ptThis, this.tCursor))) {
+                    break;
+                } else if (!sink_next(ptThis)) {
+                    SINK_FLUSH_RESET_FSM();
+                    return fsm_rt_cpl;
+                }
+            } while (true);
+            hwWork += sink_build_run(ptThis, fnSource, pSource);
+            this.chState = SINK_FLUSH_OUTPUT;
+            //break;
+
+        case SINK_FLUSH_OUTPUT:
+            tFSM = sink_output(ptThis);
+            if (IS_FSM_ERR(tFSM)) {
+                SINK_FLUSH_RESET_FSM();
+                return tFSM;
+            } else if (fsm_rt_cpl != tFSM) {
+                break;
+            } else if (!sink_skip_run(ptThis)) {
+                SINK_FLUSH_RESET_FSM();
+                return fsm_rt_cpl;
+            }
+            this.chState = SINK_FLUSH_DIFF;
+            break;
+    }
+
+    return fsm_rt_on_going;
+}
+
+/*! \brief read a cell of a rendered canvas
+ */
+static grid_cell_t sink_canvas_cell(void *pSource, grid_t tGrid)
+{
+    return *sink_front((CLASS(grid_sink_t) *)pSource, tGrid);
+}
+
+/*! \brief initialize a sink, the next flush repaints the whole device
+ *! \param ptSink target sink
+ *! \param ptGDC output device
+ *! \param ptFront cell buffer with the same size as the output device
+ *! \retval true sink is initialized
+ *! \retval false invalid parameter
+ */
+bool grid_sink_init(grid_sink_t *ptSink, const i_gdc_t *ptGDC, grid_cell_t *ptFront)
+{
+    CLASS(grid_sink_t) *ptThis = (CLASS(grid_sink_t) *)ptSink;
+
+    if ((NULL == ptSink) || (NULL == ptGDC) || (NULL == ptFront)) {
+        return false;
+    }
+
+    this.ptNext = NULL;
+    this.ptGDC = ptGDC;
+    this.ptFront = ptFront;
+    this.chState = 0;
+    this.chOutput = 0;
+    this.hwBudget = 0;
+    sink_invalidate(ptThis);
+
+    return true;
+}
+
+/*! \brief forget what the device of a sink displays, e.g. after the device
+ *!        is cleared, so the next flush repaints it
+ *! \param ptSink target sink
+ *! \return none
+ */
+void grid_sink_invalidate(grid_sink_t *ptSink)
+{
+    if (NULL == ptSink) {
+        return ;
+    }
+
+    sink_invalidate((CLASS(grid_sink_t) *)ptSink);
+}
+
+/*! \brief limit the work of a sink flush call, a flush which examined the
+ *!        specified number of cells returns fsm_rt_on_going and continues
+ *!        from where it stopped in the next call
+ *! \param ptSink target sink
+ *! \param hwCells cells examined per call, 0 for no limit
+ *! \return none
+ */
+void grid_sink_set_budget(grid_sink_t *ptSink, uint_fast16_t hwCells)
+{
+    CLASS(grid_sink_t) *ptThis = (CLASS(grid_sink_t) *)ptSink;
+
+    if (NULL == ptSink) {
+        return ;
+    }
+
+    this.hwBudget = hwCells;
+}
+
+/*! \brief initialize a compositor
+ *! \param ptCompositor target compositor
+ *! \param ptGDC output device
+ *! \param ptFront cell buffer with the same size as the output device
+ *! \param tBlank cell shown where no layer covers
+ *! \retval true compositor is initialized
+ *! \retval false invalid parameter
+ */
+bool grid_compositor_init(grid_compositor_t *ptCompositor,
+        const i_gdc_t *ptGDC, grid_cell_t *ptFront, grid_cell_t tBlank)
+{
+    CLASS(grid_compositor_t) *ptThis = (CLASS(grid_compositor_t) *)ptCompositor;
+
+    if (NULL == ptCompositor) {
+        return false;
+    } else if (GRID_CELL_TRANSPARENT == tBlank.chChar) {
+        return false;
+    } else if (!grid_sink_init((grid_sink_t *)&this.tSink, ptGDC, ptFront)) {
+        return false;
+    }
+
+    grid_screen_init((grid_screen_t *)&this.tScreen);
+    this.ptScreen = &this.tScreen;
+    this.tBlank = tBlank;
+    this.ptScroll = NULL;
+    this.chState = 0;
+
+    return true;
+}
+
+/*! \brief put a layer on top of the layer stack of the screen being shown
+ *! \param ptCompositor target compositor
+ *! \param ptLayer target layer
+ *! \retval true layer is added
+ *! \retval false invalid parameter or the layer is already in the stack
+ */
+bool grid_compositor_push_layer(
+        grid_compositor_t *ptCompositor, grid_layer_t *ptLayer)
+{
+    CLASS(grid_compositor_t) *ptThis = (CLASS(grid_compositor_t) *)ptCompositor;
+
+    if (NULL == ptCompositor) {
+        return false;
+    }
+
+    return grid_screen_push_layer((grid_screen_t *)this.ptScreen, ptLayer);
+}
+
+/*! \brief remove a layer from the layer stack of the screen being shown
+ *! \param ptCompositor target compositor
+ *! \param ptLayer target layer
+ *! \retval true layer is removed
+ *! \retval false the layer is not in the stack
+ */
+bool grid_compositor_remove_layer(
+        grid_compositor_t *ptCompositor, grid_layer_t *ptLayer)
+{
+    CLASS(grid_compositor_t) *ptThis = (CLASS(grid_compositor_t) *)ptCompositor;
+
+    if (NULL == ptCompositor) {
+        return false;
+    }
+
+    return grid_screen_remove_layer((grid_screen_t *)this.ptScreen, ptLayer);
+}
+
+/*! \brief show another screen, the next flush only outputs the cells which
+ *!        differ from what the device displays
+ *! \param ptCompositor target compositor
+ *! \param ptScreen target screen, NULL for the default screen
+ *! \retval true the screen is shown
+ *! \retval false invalid parameter
+ */
+bool grid_compositor_switch(grid_compositor_t *ptCompositor, grid_screen_t *ptScreen)
+{
+    CLASS(grid_compositor_t) *ptThis = (CLASS(grid_compositor_t) *)ptCompositor;
+    CLASS(grid_layer_t) *ptLayer;
+
+    if (NULL == ptCompositor) {
+        return false;
+    } else if (NULL == ptScreen) {
+        ptScreen = (grid_screen_t *)&this.tScreen;
+    }
+
+    this.ptScreen = (CLASS(grid_screen_t) *)ptScreen;
+
+    //! the device shows nothing of the new screen, scrolling doesn't help
+    for (ptLayer = this.ptScreen->ptTop; NULL != ptLayer; ptLayer = ptLayer->ptNext) {
+        ptLayer->nScroll = 0;
+    }
+    sink_damage(&this.tSink, sink_screen(&this.tSink));
+
+    return true;
+}
+
+/*! \brief forget what the device displays, e.g. after the device is cleared,
+ *!        so the next flush repaints the whole screen
+ *! \param ptCompositor target compositor
+ *! \return none
+ */
+void grid_compositor_invalidate(grid_compositor_t *ptCompositor)
+{
+    CLASS(grid_compositor_t) *ptThis = (CLASS(grid_compositor_t) *)ptCompositor;
+
+    if (NULL == ptCompositor) {
+        return ;
+    }
+
+    sink_invalidate(&this.tSink);
+}
+
+/*! \brief limit the work of a compositor flush or a mirror render call, a
+ *!        call which examined the specified number of cells returns
+ *!        fsm_rt_on_going and continues from where it stopped in the next call
+ *! \param ptCompositor target compositor
+ *! \param hwCells cells examined per call, 0 for no limit
+ *! \return none
+ */
+void grid_compositor_set_budget(grid_compositor_t *ptCompositor, uint_fast16_t hwCells)
+{
+    CLASS(grid_compositor_t) *ptThis = (CLASS(grid_compositor_t) *)ptCompositor;
+
+    if (NULL == ptCompositor) {
+        return ;
+    }
+
+    this.tSink.hwBudget = hwCells;
+}
+
+/*! \brief find a layer whose movement could be done by scrolling the device,
+ *!        movement of other layers is dropped as their regions are damaged
+ */
+static CLASS(grid_layer_t) *compositor_find_scroll(CLASS(grid_compositor_t) *ptThis)
+{
+    const i_gdc_t *ptGDC = this.tSink.ptGDC;
+    CLASS(grid_layer_t) *ptLayer;
+
+    for (ptLayer = this.ptScreen->ptTop; NULL != ptLayer; ptLayer = ptLayer->ptNext) {
+        if (0 == ptLayer->nScroll) {
+            continue;
+        } else if (     (NULL != ptGDC->Scroll)
+                    &&  (ptLayer->chFlag & GRID_LAYER_VISIBLE)
+                    &&  (ptLayer->chFlag & GRID_LAYER_OPAQUE)
+                    &&  (0 == ptLayer->tRegion.chLeft)
+                    &&  (ptGDC->Info.chWidth == ptLayer->tRegion.chWidth)
+                    &&  (ptLayer->tRegion.chTop >= 0)
+                    &&  (   ptLayer->tRegion.chTop + ptLayer->tRegion.chHeight
+                        <=  ptGDC->Info.chHeight)
+                    &&  (ABS(ptLayer->nScroll) < ptLayer->tRegion.chHeight)) {
+            return ptLayer;
+        }
+        ptLayer->nScroll = 0;
+    }
+
+    return NULL;
+}
+
+/*! \brief move rows of the front buffer in the same way as the device scrolls,
+ *!        rows exposed are unknown
+ */
+static void compositor_scroll_front(
+    CLASS(grid_compositor_t) *ptThis, grid_rect_t tRegion, int_fast8_t chOffset)
+{
+    uint_fast16_t hwWidth = this.tSink.ptGDC->Info.chWidth;
+    grid_cell_t *ptTarget, *ptSource;
+    uint_fast16_t hwCount;
+
+    hwCount = (tRegion.chHeight - ABS(chOffset)) * hwWidth;
+    if (chOffset > 0) {
+        //! copy backward as the content moves towards higher y
+        ptTarget = &this.tSink.ptFront[(tRegion.chTop + tRegion.chHeight) * hwWidth];
+        ptSource = ptTarget - chOffset * hwWidth;
+        while (hwCount--) {
+            *--ptTarget = *--ptSource;
+        }
+        ptTarget = &this.tSink.ptFront[tRegion.chTop * hwWidth];
+    } else {
+        ptTarget = &this.tSink.ptFront[tRegion.chTop * hwWidth];
+        ptSource = ptTarget - chOffset * hwWidth;
+        while (hwCount--) {
+            *ptTarget++ = *ptSource++;
+        }
+    }
+
+    hwCount = ABS(chOffset) * hwWidth;
+    while (hwCount--) {
+        ptTarget->chChar = GRID_CELL_TRANSPARENT;
+        ptTarget++;
+    }
+}
+
+/*! \brief collect damage of the screen being shown and all its layers
+ */
+static grid_rect_t compositor_collect_damage(CLASS(grid_compositor_t) *ptThis)
+{
+    CLASS(grid_layer_t) *ptLayer;
+    grid_rect_t tDamage = this.ptScreen->tDamage;
+
+    this.ptScreen->tDamage.chWidth = 0;
+    this.ptScreen->tDamage.chHeight = 0;
+    for (ptLayer = this.ptScreen->ptTop; NULL != ptLayer; ptLayer = ptLayer->ptNext) {
+        tDamage = grid_rect_union(tDamage, ptLayer->tDamage);
+        ptLayer->tDamage.chWidth = 0;
+        ptLayer->tDamage.chHeight = 0;
+    }
+
+    return tDamage;
+}
+
+/*! \brief find the visible cell at a specified screen position
+ */
+static grid_cell_t compositor_compose(CLASS(grid_compositor_t) *ptThis, grid_t tGrid)
+{
+    CLASS(grid_layer_t) *ptLayer;
+
+    //! search from top to bottom, the first solid cell wins
+    for (ptLayer = this.ptScreen->ptTop; NULL != ptLayer; ptLayer = ptLayer->ptNext) {
+        grid_t tLocal;
+        grid_cell_t *ptCell;
+
+        if (    !(ptLayer->chFlag & GRID_LAYER_VISIBLE)
+            ||  !grid_rect_contains(ptLayer->tRegion, tGrid)) {
+            continue;
+        }
+
+        tLocal.chX = tGrid.chX - ptLayer->tRegion.chLeft;
+        tLocal.chY = tGrid.chY - ptLayer->tRegion.chTop;
+        ptCell = layer_cell(ptLayer, tLocal);
+        if (GRID_CELL_TRANSPARENT != ptCell->chChar) {
+            return *ptCell;
+        } else if (ptLayer->chFlag & GRID_LAYER_OPAQUE) {
+            //! a transparent cell of an opaque layer hides cells below it
+            return this.tBlank;
+        }
+    }
+
+    return this.tBlank;
+}
+
+/*! \brief composite a cell for the sink of a compositor
+ */
+static grid_cell_t compositor_cell(void *pSource, grid_t tGrid)
+{
+    return compositor_compose((CLASS(grid_compositor_t) *)pSource, tGrid);
+}
+
+#define COMPOSITOR_FLUSH_START          0
+#define COMPOSITOR_FLUSH_SCROLL         1
+#define COMPOSITOR_FLUSH_DRAW           2
+#define COMPOSITOR_FLUSH_RESET_FSM()    do { this.chState = 0; } while (0)
+
+/*! \brief composite damaged areas of all layers and output the cells which
+ *!        differ from what the device displays, changed cells sharing a brush
+ *!        are merged into text runs printed at once
+ *! \param ptCompositor target compositor
+ *! \retval fsm_rt_on_going flush on going
+ *! \retval fsm_rt_cpl flush finish
+ *! \retval fsm_rt_err output device error
+ */
+fsm_rt_t grid_compositor_flush(grid_compositor_t *ptCompositor)
+{
+    CLASS(grid_compositor_t) *ptThis = (CLASS(grid_compositor_t) *)ptCompositor;
+    fsm_rt_t tFSM;
+
+    if (NULL == ptCompositor) {
+        return fsm_rt_err;
+    }
+    TGUI_TRACE_RESUME(TGUI_TRACE_FLUSH);
+
+    switch (this.chState) {
+        case COMPOSITOR_FLUSH_START:
+            //! scroll the device before compositing, one layer at a time
+            this.ptScroll = compositor_find_scroll(ptThis);
+            if (NULL == this.ptScroll) {
+                this.chState = COMPOSITOR_FLUSH_DRAW;
+                break;
+            }
+            this.chScroll = this.ptScroll->nScroll;
+            this.chState = COMPOSITOR_FLUSH_SCROLL;
+            //break;
+
+        case COMPOSITOR_FLUSH_SCROLL:
+            tFSM = this.tSink.ptGDC->Scroll(this.ptScroll->tRegion, this.chScroll);
+            if (fsm_rt_on_going == tFSM) {
+                break;
+            } else if (fsm_rt_cpl == tFSM) {
+                compositor_scroll_front(ptThis, this.ptScroll->tRegion, this.chScroll);
+                this.ptScroll->nScroll -= this.chScroll;
+            } else {
+                //! the region is damaged, repaint it instead
+                this.ptScroll->nScroll = 0;
+            }
+            this.tSink.chFlag &= ~SINK_PEN_VALID;
+            this.chState = COMPOSITOR_FLUSH_START;
+            break;
+
+        case COMPOSITOR_FLUSH_DRAW:
+            if (SINK_FLUSH_START == this.tSink.chState) {
+                sink_damage(&this.tSink, compositor_collect_damage(ptThis));
+            }
+            tFSM = sink_flush(&this.tSink, sink_screen(&this.tSink), compositor_cell, ptThis);
+            if (fsm_rt_on_going == tFSM) {
+                break;
+            }
+            COMPOSITOR_FLUSH_RESET_FSM();
+            return TGUI_TRACE_PAUSE(TGUI_TRACE_FLUSH, tFSM);
+    }
+
+    return TGUI_TRACE_PAUSE(TGUI_TRACE_FLUSH, fsm_rt_on_going);
+}
+
+#define COMPOSITOR_RENDER_START         0
+#define COMPOSITOR_RENDER_COMPOSE       1
+
+/*! \brief composite damaged areas into the front buffer of a compositor
+ *!        without touching its device, the work is limited by the budget of
+ *!        the compositor and continues in the next call
+ *! \param ptChanged the area changed by this call
+ *! \retval true rendering is finished
+ *! \retval false rendering continues in the next call
+ */
+static bool compositor_render(CLASS(grid_compositor_t) *ptThis, grid_rect_t *ptChanged)
+{
+    CLASS(grid_sink_t) *ptCanvas = &this.tSink;
+    uint_fast16_t hwWork = 0;
+
+    ptChanged->chLeft = 0;
+    ptChanged->chTop = 0;
+    ptChanged->chWidth = 0;
+    ptChanged->chHeight = 0;
+
+    if (COMPOSITOR_RENDER_START == ptCanvas->chState) {
+        CLASS(grid_layer_t) *ptLayer;
+
+        //! there is no device to scroll, the damage covers moved layers
+        for (ptLayer = this.ptScreen->ptTop; NULL != ptLayer; ptLayer = ptLayer->ptNext) {
+            ptLayer->nScroll = 0;
+        }
+
+        sink_damage(ptCanvas, compositor_collect_damage(ptThis));
+        if (!sink_start(ptCanvas, sink_screen(ptCanvas))) {
+            return true;
+        }
+        ptCanvas->chState = COMPOSITOR_RENDER_COMPOSE;
+    }
+
+    do {
+        grid_cell_t tCell;
+        grid_cell_t *ptFront;
+
+        if ((0 != ptCanvas->hwBudget) && (hwWork++ >= ptCanvas->hwBudget)) {
+            return false;
+        }
+
+        tCell = compositor_compose(ptThis, ptCanvas->tCursor);
+        ptFront = sink_front(ptCanvas, ptCanvas->tCursor);
+        if (!IS_CELL_EQUAL(tCell, *ptFront)) {
+            grid_rect_t tCellRect;
+
+            *ptFront = tCell;
+            tCellRect.__grid_t = ptCanvas->tCursor;
+            tCellRect.chWidth = 1;
+            tCellRect.chHeight = 1;
+            *ptChanged = grid_rect_union(*ptChanged, tCellRect);
+        }
+    } while (sink_next(ptCanvas));
+
+    ptCanvas->chState = COMPOSITOR_RENDER_START;
+
+    return true;
+}
+
+/*! \brief initialize a mirror, the front buffer of the source compositor
+ *!        holds the canvas shown by all sinks, the device of the source
+ *!        compositor gives the canvas size and is never written
+ *! \param ptMirror target mirror
+ *! \param ptSource compositor rendering the canvas
+ *! \retval true mirror is initialized
+ *! \retval false invalid parameter
+ */
+bool grid_mirror_init(grid_mirror_t *ptMirror, grid_compositor_t *ptSource)
+{
+    CLASS(grid_mirror_t) *ptThis = (CLASS(grid_mirror_t) *)ptMirror;
+
+    if ((NULL == ptMirror) || (NULL == ptSource)) {
+        return false;
+    }
+
+    this.ptSource = (CLASS(grid_compositor_t) *)ptSource;
+    this.ptSinks = NULL;
+
+    return true;
+}
+
+/*! \brief add a sink to a mirror
+ *! \param ptMirror target mirror
+ *! \param ptSink target sink
+ *! \retval true sink is added
+ *! \retval false invalid parameter or the sink is already added
+ */
+bool grid_mirror_add_sink(grid_mirror_t *ptMirror, grid_sink_t *ptSink)
+{
+    CLASS(grid_mirror_t) *ptThis = (CLASS(grid_mirror_t) *)ptMirror;
+    CLASS(grid_sink_t) *ptSNK = (CLASS(grid_sink_t) *)ptSink;
+    CLASS(grid_sink_t) *ptItem;
+
+    if ((NULL == ptMirror) || (NULL == ptSink)) {
+        return false;
+    }
+    for (ptItem = this.ptSinks; NULL != ptItem; ptItem = ptItem->ptNext) {
+        if (ptItem == ptSNK) {
+            return false;
+        }
+    }
+
+    ptSNK->ptNext = this.ptSinks;
+    this.ptSinks = ptSNK;
+
+    return true;
+}
+
+/*! \brief remove a sink from a mirror
+ *! \param ptMirror target mirror
+ *! \param ptSink target sink
+ *! \retval true sink is removed
+ *! \retval false the sink is not added
+ */
+bool grid_mirror_remove_sink(grid_mirror_t *ptMirror, grid_sink_t *ptSink)
+{
+    CLASS(grid_mirror_t) *ptThis = (CLASS(grid_mirror_t) *)ptMirror;
+    CLASS(grid_sink_t) *ptSNK = (CLASS(grid_sink_t) *)ptSink;
+    CLASS(grid_sink_t) **pptItem;
+
+    if ((NULL == ptMirror) || (NULL == ptSink)) {
+        return false;
+    }
+
+    for (pptItem = &this.ptSinks; NULL != (*pptItem); pptItem = &((*pptItem)->ptNext)) {
+        if ((*pptItem) == ptSNK) {
+            (*pptItem) = ptSNK->ptNext;
+            ptSNK->ptNext = NULL;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*! \brief render the canvas once and let every sink output its own
+ *!        difference, a slow sink only falls behind without stalling others
+ *! \param ptMirror target mirror
+ *! \retval fsm_rt_on_going some sinks are still outputting
+ *! \retval fsm_rt_cpl all sinks show the canvas
+ *! \retval fsm_rt_err a sink met an output device error, it repaints the
+ *!         damaged area in the next flush
+ */
+fsm_rt_t grid_mirror_flush(grid_mirror_t *ptMirror)
+{
+    CLASS(grid_mirror_t) *ptThis = (CLASS(grid_mirror_t) *)ptMirror;
+    CLASS(grid_sink_t) *ptSink;
+    fsm_rt_t tResult = fsm_rt_cpl;
+    grid_rect_t tChanged;
+
+    if (NULL == ptMirror) {
+        return fsm_rt_err;
+    }
+    TGUI_TRACE_RESUME(TGUI_TRACE_FLUSH);
+
+    if (!compositor_render(this.ptSource, &tChanged)) {
+        tResult = fsm_rt_on_going;
+    }
+
+    for (ptSink = this.ptSinks; NULL != ptSink; ptSink = ptSink->ptNext) {
+        fsm_rt_t tFSM;
+
+        //! cells already visited by an on-going flush are output next time
+        sink_damage(ptSink, tChanged);
+        tFSM = sink_flush(ptSink, sink_screen(&this.ptSource->tSink),
+                            sink_canvas_cell, &this.ptSource->tSink);
+        if (IS_FSM_ERR(tFSM)) {
+            sink_damage(ptSink, ptSink->tWindow);
+            tResult = tFSM;
+        } else if (IS_FSM_ERR(tResult)) {
+            continue;
+        } else if (     (fsm_rt_on_going == tFSM)
+                    ||  !grid_rect_is_empty(ptSink->tDamage)) {
+            //! damage rendered during the flush is not output yet
+            tResult = fsm_rt_on_going;
+        }
+    }
+
+    return TGUI_TRACE_PAUSE(TGUI_TRACE_FLUSH, tResult);
+}
+
+#endif  /* USE_SERVICE_GUI_TGUI == ENABLED */
+
+/* EOF */
@@ -0,0 +1,367 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __TGUI_GRID_CANVAS_H__
+#define __TGUI_GRID_CANVAS_H__
+
+/*============================ INCLUDES ======================================*/
+#include ".\app_cfg.h"
+
+#if USE_SERVICE_GUI_TGUI == ENABLED
+#include "..\interface.h"
+
+/*============================ MACROS ========================================*/
+//! \brief character code of a transparent cell
+#define GRID_CELL_TRANSPARENT           (0x00)
+
+//! \name layer flag
+//! @{
+#define GRID_LAYER_VISIBLE              _BV(0)      //!< layer is shown
+#define GRID_LAYER_OPAQUE               _BV(1)      //!< layer hides everything below it
+//! @}
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+//! \brief number of cells required by a layer or a compositor front buffer
+#define GRID_CELL_BUFFER_SIZE(__WIDTH, __HEIGHT)    ((__WIDTH) * (__HEIGHT))
+
+/*============================ TYPES =========================================*/
+
+//! \name grid layer
+//! @{
+EXTERN_CLASS(grid_layer_t)
+    grid_layer_t       *ptNext;         //!< next layer below
+    grid_cell_t        *ptCells;        //!< cell buffer
+    grid_rect_t         tRegion;        //!< position and size on the screen
+    grid_rect_t         tDamage;        //!< damaged area on the screen
+    uint_fast16_t       hwLines;        //!< number of lines in the cell buffer
+    uint_fast16_t       hwScroll;       //!< first line shown in the region
+    int_fast16_t        nScroll;        //!< content movement not shown yet
+    uint_fast8_t        chFlag;         //!< layer flag
+END_EXTERN_CLASS(grid_layer_t)
+//! @}
+
+//! \name grid screen
+//! @{
+EXTERN_CLASS(grid_screen_t)
+    grid_layer_t       *ptTop;          //!< top of the layer stack
+    grid_rect_t         tDamage;        //!< damage of removed layers
+END_EXTERN_CLASS(grid_screen_t)
+//! @}
+
+//! \name grid sink
+//! @{
+EXTERN_CLASS(grid_sink_t)
+    grid_sink_t        *ptNext;         //!< next sink of the same mirror
+    const i_gdc_t      *ptGDC;          //!< output device
+    grid_cell_t        *ptFront;        //!< what the device displays now
+    grid_rect_t         tDamage;        //!< area which may differ from the device
+    grid_rect_t         tWindow;        //!< area visited by current flush
+    grid_t              tCursor;        //!< cell visited by current flush
+    grid_t              tPen;           //!< device cursor position
+    grid_cell_t         tCell;          //!< brush and first cell of the run
+    uint8_t             chRun[GRID_SINK_RUN_SIZE];  //!< text run being output
+    uint8_t             chRunSize;      //!< characters in the run
+    uint_fast8_t        chFlag;
+    uint_fast8_t        chState;        //!< state of flush
+    uint_fast8_t        chOutput;       //!< state of cell output
+    uint_fast16_t       hwBudget;       //!< cells examined per call, 0 for no limit
+END_EXTERN_CLASS(grid_sink_t)
+//! @}
+
+//! \name grid compositor
+//! @{
+EXTERN_CLASS(grid_compositor_t)
+    grid_sink_t         tSink;          //!< output device and its front buffer
+    grid_screen_t      *ptScreen;       //!< screen being shown
+    grid_screen_t       tScreen;        //!< default screen
+    grid_cell_t         tBlank;         //!< cell shown where no layer covers
+    grid_layer_t       *ptScroll;       //!< layer being scrolled on the device
+    int_fast8_t         chScroll;       //!< movement being scrolled
+    uint_fast8_t        chState;
+END_EXTERN_CLASS(grid_compositor_t)
+//! @}
+
+//! \name grid mirror
+//! @{
+EXTERN_CLASS(grid_mirror_t)
+    grid_compositor_t  *ptSource;       //!< compositor rendering the canvas
+    grid_sink_t        *ptSinks;        //!< sinks showing the canvas
+END_EXTERN_CLASS(grid_mirror_t)
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+/*! \brief initialize a layer, all cells are transparent after initialization
+ *! \param ptLayer target layer
+ *! \param ptCells cell buffer with GRID_CELL_BUFFER_SIZE() cells
+ *! \param tRegion position and size of the layer on the screen
+ *! \param chFlag layer flag
+ *! \retval true layer is initialized
+ *! \retval false invalid parameter
+ */
+extern bool grid_layer_init(grid_layer_t *ptLayer, grid_cell_t *ptCells,
+                            grid_rect_t tRegion, uint_fast8_t chFlag);
+
+/*! \brief initialize a layer which holds more lines than its region shows,
+ *!        all cells are transparent after initialization
+ *! \param ptLayer target layer
+ *! \param ptCells cell buffer with GRID_CELL_BUFFER_SIZE(width, hwLines) cells
+ *! \param tRegion position and size of the layer on the screen
+ *! \param hwLines number of lines, it should not be less than the region height
+ *! \param chFlag layer flag
+ *! \retval true layer is initialized
+ *! \retval false invalid parameter
+ */
+extern bool grid_layer_init_ex(grid_layer_t *ptLayer, grid_cell_t *ptCells,
+        grid_rect_t tRegion, uint_fast16_t hwLines, uint_fast8_t chFlag);
+
+/*! \brief write a cell of a layer
+ *! \param ptLayer target layer
+ *! \param tGrid cell position inside the region of the layer
+ *! \param tCell new cell value
+ *! \retval true cell is written
+ *! \retval false the position is outside the layer
+ */
+extern bool grid_layer_set_cell(grid_layer_t *ptLayer, grid_t tGrid, grid_cell_t tCell);
+
+/*! \brief read a cell of a layer
+ *! \param ptLayer target layer
+ *! \param tGrid cell position inside the region of the layer
+ *! \param ptCell buffer for the cell value
+ *! \retval true cell is read
+ *! \retval false the position is outside the layer
+ */
+extern bool grid_layer_get_cell(grid_layer_t *ptLayer, grid_t tGrid, grid_cell_t *ptCell);
+
+/*! \brief print a string into a layer, the string is cut at the layer edge
+ *! \param ptLayer target layer
+ *! \param tGrid start position inside the region of the layer
+ *! \param tBrush display attribute
+ *! \param pchString string buffer
+ *! \param hwSize string length
+ *! \return the number of characters written
+ */
+extern uint_fast16_t grid_layer_print(grid_layer_t *ptLayer, grid_t tGrid,
+        grid_brush_t tBrush, const uint8_t *pchString, uint_fast16_t hwSize);
+
+/*! \brief print a string into any line of a layer, no matter it is shown or
+ *!        not, the string is cut at the layer edge
+ *! \param ptLayer target layer
+ *! \param hwLine target line
+ *! \param chColumn start column
+ *! \param tBrush display attribute
+ *! \param pchString string buffer
+ *! \param hwSize string length
+ *! \return the number of characters written
+ */
+extern uint_fast16_t grid_layer_print_line(grid_layer_t *ptLayer,
+        uint_fast16_t hwLine, int_fast8_t chColumn, grid_brush_t tBrush,
+        const uint8_t *pchString, uint_fast16_t hwSize);
+
+/*! \brief choose the first line shown in the region of a layer, the
+ *!        compositor scrolls the device instead of repainting the region
+ *!        when the layer is opaque and as wide as the screen
+ *! \param ptLayer target layer
+ *! \param hwLine first line to show
+ *! \retval true layer is panned
+ *! \retval false invalid parameter
+ */
+extern bool grid_layer_pan(grid_layer_t *ptLayer, uint_fast16_t hwLine);
+
+/*! \brief fill an area of a layer with the same cell
+ *! \param ptLayer target layer
+ *! \param tRect target area inside the region of the layer
+ *! \param tCell cell value, use GRID_CELL_TRANSPARENT to clear the area
+ *! \retval true the area is filled
+ *! \retval false the area is outside the layer
+ */
+extern bool grid_layer_fill(grid_layer_t *ptLayer, grid_rect_t tRect, grid_cell_t tCell);
+
+/*! \brief move a layer to a new position on the screen
+ *! \param ptLayer target layer
+ *! \param tGrid new position of the top-left cell
+ *! \retval true layer is moved
+ *! \retval false invalid parameter
+ */
+extern bool grid_layer_move(grid_layer_t *ptLayer, grid_t tGrid);
+
+/*! \brief show or hide a layer
+ *! \param ptLayer target layer
+ *! \param bVisible true for showing the layer
+ *! \retval true layer visibility is set
+ *! \retval false invalid parameter
+ */
+extern bool grid_layer_show(grid_layer_t *ptLayer, bool bVisible);
+
+/*! \brief initialize a screen, a screen is a layer stack which could be
+ *!        updated in background and shown by a compositor later
+ *! \param ptScreen target screen
+ *! \retval true screen is initialized
+ *! \retval false invalid parameter
+ */
+extern bool grid_screen_init(grid_screen_t *ptScreen);
+
+/*! \brief put a layer on top of the layer stack of a screen
+ *! \param ptScreen target screen
+ *! \param ptLayer target layer
+ *! \retval true layer is added
+ *! \retval false invalid parameter or the layer is already in the stack
+ */
+extern bool grid_screen_push_layer(grid_screen_t *ptScreen, grid_layer_t *ptLayer);
+
+/*! \brief remove a layer from the layer stack of a screen
+ *! \param ptScreen target screen
+ *! \param ptLayer target layer
+ *! \retval true layer is removed
+ *! \retval false the layer is not in the stack
+ */
+extern bool grid_screen_remove_layer(grid_screen_t *ptScreen, grid_layer_t *ptLayer);
+
+/*! \brief initialize a sink, the next flush repaints the whole device
+ *! \param ptSink target sink
+ *! \param ptGDC output device
+ *! \param ptFront cell buffer with the same size as the output device
+ *! \retval true sink is initialized
+ *! \retval false invalid parameter
+ */
+extern bool grid_sink_init(grid_sink_t *ptSink, const i_gdc_t *ptGDC, grid_cell_t *ptFront);
+
+/*! \brief forget what the device of a sink displays, e.g. after the device
+ *!        is cleared, so the next flush repaints it
+ *! \param ptSink target sink
+ *! \return none
+ */
+extern void grid_sink_invalidate(grid_sink_t *ptSink);
+
+/*! \brief limit the work of a sink flush call, a flush which examined the
+ *!        specified number of cells returns fsm_rt_on_going and continues
+ *!        from where it stopped in the next call
+ *! \param ptSink target sink
+ *! \param hwCells cells examined per call, 0 for no limit
+ *! \return none
+ */
+extern void grid_sink_set_budget(grid_sink_t *ptSink, uint_fast16_t hwCells);
+
+/*! \brief initialize a compositor
+ *! \param ptCompositor target compositor
+ *! \param ptGDC output device
+ *! \param ptFront cell buffer with the same size as the output device
+ *! \param tBlank cell shown where no layer covers
+ *! \retval true compositor is initialized
+ *! \retval false invalid parameter
+ */
+extern bool grid_compositor_init(grid_compositor_t *ptCompositor,
+        const i_gdc_t *ptGDC, grid_cell_t *ptFront, grid_cell_t tBlank);
+
+/*! \brief put a layer on top of the layer stack of the screen being shown
+ *! \param ptCompositor target compositor
+ *! \param ptLayer target layer
+ *! \retval true layer is added
+ *! \retval false invalid parameter or the layer is already in the stack
+ */
+extern bool grid_compositor_push_layer(
+        grid_compositor_t *ptCompositor, grid_layer_t *ptLayer);
+
+/*! \brief remove a layer from the layer stack of the screen being shown
+ *! \param ptCompositor target compositor
+ *! \param ptLayer target layer
+ *! \retval true layer is removed
+ *! \retval false the layer is not in the stack
+ */
+extern bool grid_compositor_remove_layer(
+        grid_compositor_t *ptCompositor, grid_layer_t *ptLayer);
+
+/*! \brief show another screen, the next flush only outputs the cells which
+ *!        differ from what the device displays
+ *! \param ptCompositor target compositor
+ *! \param ptScreen target screen, NULL for the default screen
+ *! \retval true the screen is shown
+ *! \retval false invalid parameter
+ */
+extern bool grid_compositor_switch(grid_compositor_t *ptCompositor, grid_screen_t *ptScreen);
+
+/*! \brief forget what the device displays, e.g. after the device is cleared,
+ *!        so the next flush repaints the whole screen
+ *! \param ptCompositor target compositor
+ *! \return none
+ */
+extern void grid_compositor_invalidate(grid_compositor_t *ptCompositor);
+
+/*! \brief limit the work of a compositor flush or a mirror render call, a
+ *!        call which examined the specified number of cells returns
+ *!        fsm_rt_on_going and continues from where it stopped in the next call
+ *! \param ptCompositor target compositor
+ *! \param hwCells cells examined per call, 0 for no limit
+ *! \return none
+ */
+extern void grid_compositor_set_budget(grid_compositor_t *ptCompositor, uint_fast16_t hwCells);
+
+/*! \brief composite damaged areas of all layers and output the cells which
+ *!        differ from what the device displays, changed cells sharing a brush
+ *!        are merged into text runs printed at once
+ *! \param ptCompositor target compositor
+ *! \retval fsm_rt_on_going flush on going
+ *! \retval fsm_rt_cpl flush finish
+ *! \retval fsm_rt_err output device error
+ */
+extern fsm_rt_t grid_compositor_flush(grid_compositor_t *ptCompositor);
+
+/*! \brief initialize a mirror, the front buffer of the source compositor
+ *!        holds the canvas shown by all sinks, the device of the source
+ *!        compositor gives the canvas size and is never written
+ *! \param ptMirror target mirror
+ *! \param ptSource compositor rendering the canvas
+ *! \retval true mirror is initialized
+ *! \retval false invalid parameter
+ */
+extern bool grid_mirror_init(grid_mirror_t *ptMirror, grid_compositor_t *ptSource);
+
+/*! \brief add a sink to a mirror
+ *! \param ptMirror target mirror
+ *! \param ptSink target sink
+ *! \retval true sink is added
+ *! \retval false invalid parameter or the sink is already added
+ */
+extern bool grid_mirror_add_sink(grid_mirror_t *ptMirror, grid_sink_t *ptSink);
+
+/*! \brief remove a sink from a mirror
+ *! \param ptMirror target mirror
+ *! \param ptSink target sink
+ *! \retval true sink is removed
+ *! \retval false the sink is not added
+ */
+extern bool grid_mirror_remove_sink(grid_mirror_t *ptMirror, grid_sink_t *ptSink);
+
+/*! \brief render the canvas once and let every sink output its own
+ *!        difference, a slow sink only falls behind without stalling others
+ *! \param ptMirror target mirror
+ *! \retval fsm_rt_on_going some sinks are still outputting
+ *! \retval fsm_rt_cpl all sinks show the canvas
+ *! \retval fsm_rt_err a sink met an output device error, it repaints the
+ *!         damaged area in the next flush
+ */
+extern fsm_rt_t grid_mirror_flush(grid_mirror_t *ptMirror);
+
+#endif  /* USE_SERVICE_GUI_TGUI == ENABLED */
+
+#endif  /* __TGUI_GRID_CANVAS_H__ */
+
+/* EOF */
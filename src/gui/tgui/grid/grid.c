@@ -31,5 +31,83 @@
 /*============================ PROTOTYPES ====================================*/
 /*============================ IMPLEMENTATION ================================*/
 
+/*! \brief check whether a grid rectangle covers nothing
+ *! \param tRect target rectangle
+ *! \retval true the rectangle is empty
+ *! \retval false the rectangle covers at least one grid
+ */
+bool grid_rect_is_empty(grid_rect_t tRect)
+{
+    return (tRect.chWidth <= 0) || (tRect.chHeight <= 0);
+}
+
+/*! \brief calculate the smallest rectangle which covers both rectangles
+ *! \param tA rectangle A
+ *! \param tB rectangle B
+ *! \return the bounding rectangle
+ */
+grid_rect_t grid_rect_union(grid_rect_t tA, grid_rect_t tB)
+{
+    int_fast8_t chRight, chBottom;
+
+    if (grid_rect_is_empty(tA)) {
+        return tB;
+    } else if (grid_rect_is_empty(tB)) {
+        return tA;
+    }
+
+    chRight = MAX(tA.chLeft + tA.chWidth, tB.chLeft + tB.chWidth);
+    chBottom = MAX(tA.chTop + tA.chHeight, tB.chTop + tB.chHeight);
+    tA.chLeft = MIN(tA.chLeft, tB.chLeft);
+    tA.chTop = MIN(tA.chTop, tB.chTop);
+    tA.chWidth = chRight - tA.chLeft;
+    tA.chHeight = chBottom - tA.chTop;
+
+    return tA;
+}
+
+/*! \brief calculate the overlapped area of two rectangles
+ *! \param tA rectangle A
+ *! \param tB rectangle B
+ *! \param ptResult buffer for the overlapped area, it could be NULL
+ *! \retval true two rectangles overlap
+ *! \retval false two rectangles do not overlap
+ */
+bool grid_rect_intersect(grid_rect_t tA, grid_rect_t tB, grid_rect_t *ptResult)
+{
+    grid_rect_t tRect;
+    int_fast8_t chRight = MIN(tA.chLeft + tA.chWidth, tB.chLeft + tB.chWidth);
+    int_fast8_t chBottom = MIN(tA.chTop + tA.chHeight, tB.chTop + tB.chHeight);
+
+    tRect.chLeft = MAX(tA.chLeft, tB.chLeft);
+    tRect.chTop = MAX(tA.chTop, tB.chTop);
+    tRect.chWidth = chRight - tRect.chLeft;
+    tRect.chHeight = chBottom - tRect.chTop;
+
+    if (grid_rect_is_empty(tRect)) {
+        tRect.chWidth = 0;
+        tRect.chHeight = 0;
+    }
+    if (NULL != ptResult) {
+        *ptResult = tRect;
+    }
+
+    return !grid_rect_is_empty(tRect);
+}
+
+/*! \brief check whether a grid is inside a rectangle
+ *! \param tRect target rectangle
+ *! \param tGrid target grid
+ *! \retval true the grid is inside the rectangle
+ *! \retval false the grid is outside the rectangle
+ */
+bool grid_rect_contains(grid_rect_t tRect, grid_t tGrid)
+{
+    return  (tGrid.chX >= tRect.chLeft)
+        &&  (tGrid.chY >= tRect.chTop)
+        &&  (tGrid.chX < tRect.chLeft + tRect.chWidth)
+        &&  (tGrid.chY < tRect.chTop + tRect.chHeight);
+}
+
 #endif
 /* EOF */
\ No newline at end of file
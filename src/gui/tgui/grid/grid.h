@@ -26,6 +26,9 @@
 #if USE_SERVICE_GUI_TGUI == ENABLED
 #include ".\interface.h"
 #include ".\terminal\terminal.h"
+#include ".\canvas\canvas.h"
+#include ".\async\async.h"
+#include ".\log\log.h"
 
 /*============================ MACROS ========================================*/
 /*============================ MACROFIED FUNCTIONS ===========================*/
@@ -34,6 +37,37 @@
 /*============================ LOCAL VARIABLES ===============================*/
 /*============================ PROTOTYPES ====================================*/
 
+/*! \brief check whether a grid rectangle covers nothing
+ *! \param tRect target rectangle
+ *! \retval true the rectangle is empty
+ *! \retval false the rectangle covers at least one grid
+ */
+extern bool grid_rect_is_empty(grid_rect_t tRect);
+
+/*! \brief calculate the smallest rectangle which covers both rectangles
+ *! \param tA rectangle A
+ *! \param tB rectangle B
+ *! \return the bounding rectangle
+ */
+extern grid_rect_t grid_rect_union(grid_rect_t tA, grid_rect_t tB);
+
+/*! \brief calculate the overlapped area of two rectangles
+ *! \param tA rectangle A
+ *! \param tB rectangle B
+ *! \param ptResult buffer for the overlapped area, it could be NULL
+ *! \retval true two rectangles overlap
+ *! \retval false two rectangles do not overlap
+ */
+extern bool grid_rect_intersect(grid_rect_t tA, grid_rect_t tB, grid_rect_t *ptResult);
+
+/*! \brief check whether a grid is inside a rectangle
+ *! \param tRect target rectangle
+ *! \param tGrid target grid
+ *! \retval true the grid is inside the rectangle
+ *! \retval false the grid is outside the rectangle
+ */
+extern bool grid_rect_contains(grid_rect_t tRect, grid_t tGrid);
+
 
 #endif
 #endif
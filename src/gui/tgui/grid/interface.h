@@ -62,6 +62,40 @@ typedef struct {
 } grid_brush_t;
 //! @}
 
+//! \name grid cell
+//! @{
+typedef struct {
+    uint8_t         chChar;         //!< character code
+    grid_brush_t    tBrush;         //!< display attribute
+} grid_cell_t;
+//! @}
+
+//! \name grid draw command
+//! @{
+typedef enum {
+    GRID_DRAW_MOVE      = 0,        //!< set cursor position
+    GRID_DRAW_BRUSH,                //!< set display attribute
+    GRID_DRAW_TEXT,                 //!< print a string at the cursor
+    GRID_DRAW_FILL,                 //!< fill a rectangle with a character
+} em_grid_draw_t;
+
+typedef struct {
+    uint8_t                 chCommand;      //!< em_grid_draw_t
+    union {
+        grid_t              tGrid;          //!< GRID_DRAW_MOVE
+        grid_brush_t        tBrush;         //!< GRID_DRAW_BRUSH
+        struct {
+            const uint8_t  *pchString;
+            uint16_t        hwSize;
+        } Text;                             //!< GRID_DRAW_TEXT
+        struct {
+            grid_rect_t     tRect;
+            uint8_t         chChar;
+        } Fill;                             //!< GRID_DRAW_FILL, the cursor is kept
+    };
+} grid_draw_t;
+//! @}
+
 //*! \name grid drawing context
 //! @{
 DEF_INTERFACE(i_gdc_t, 
@@ -76,6 +110,11 @@ DEF_INTERFACE(i_gdc_t,
             fsm_rt_t        (*Set)(grid_brush_t tBrush);
             grid_brush_t    (*Get)(void);
         END_DEF_INTERFACE(grid_brush_property_t)
+
+        DEF_INTERFACE(grid_viewport_property_t)
+            bool            (*Push)(grid_rect_t tViewport);
+            bool            (*Pop)(void);
+        END_DEF_INTERFACE(grid_viewport_property_t)
     )
     const struct {
         int_fast8_t         chWidth;
@@ -83,8 +122,11 @@ DEF_INTERFACE(i_gdc_t,
     }                       Info;
     grid_property_t         Position;
     grid_brush_property_t   Color;
+    grid_viewport_property_t Viewport;
     fsm_rt_t                (*Clear)(void);
     fsm_rt_t                (*Print)(uint8_t *pchString, uint_fast16_t hwSize);
+    fsm_rt_t                (*Scroll)(grid_rect_t tRegion, int_fast8_t chOffset);
+    fsm_rt_t                (*Draw)(const grid_draw_t *ptCommands, uint_fast16_t hwCount);
 END_DEF_INTERFACE(i_gdc_t)
 //! @}
 
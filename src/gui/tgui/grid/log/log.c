@@ -0,0 +1,258 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*============================ INCLUDES ======================================*/
+#include ".\app_cfg.h"
+
+#if USE_SERVICE_GUI_TGUI == ENABLED
+#include "..\interface.h"
+#include "..\grid.h"
+
+/*============================ MACROS ========================================*/
+#if (GRID_LOG_MSG_COUNT & (GRID_LOG_MSG_COUNT - 1)) != 0 || GRID_LOG_MSG_COUNT > 128
+#   error GRID_LOG_MSG_COUNT should be a power of two and 128 at most
+#endif
+
+#define GRID_LOG_MASK                   (GRID_LOG_MSG_COUNT - 1)
+
+//! \name message status
+//! @{
+#define GRID_LOG_MSG_FREE               0   //!< the slot is not used
+#define GRID_LOG_MSG_FILLING            1   //!< an ISR is writing it
+#define GRID_LOG_MSG_READY              2   //!< waiting to be drawn
+//! @}
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+
+//! \name log message
+//! @{
+typedef struct {
+    const uint8_t           *pchString;     //!< the message, it could be chPayload
+    uint8_t                 chSize;         //!< message length
+    volatile uint8_t        chStatus;       //!< message status
+    uint8_t                 chPayload[GRID_LOG_MSG_SIZE];   //!< copied message
+} grid_log_msg_t;
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+//! \note slots are taken by posters at s_chTail in a short critical section 
+//!       and filled outside of it, only the drain task moves s_chHead
+static grid_log_msg_t s_tMessage[GRID_LOG_MSG_COUNT];
+static volatile uint8_t s_chHead = 0;
+static volatile uint8_t s_chTail = 0;
+static uint32_t s_wDropped = 0;
+
+//! output
+static const i_gdc_t *s_ptGDC = NULL;
+static grid_rect_t s_tRegion;
+static int_fast8_t s_chRow = 0;
+
+/*============================ PROTOTYPES ====================================*/
+/*============================ IMPLEMENTATION ================================*/
+
+/*! \brief set where the log is shown, every message takes a row of the
+ *!        region from the top and the oldest row is reused when it is full
+ *! \param ptGDC the grid drawing context
+ *! \param tRegion the log area
+ *! \retval true the log is ready
+ *! \retval false invalid parameter or the context has no Draw
+ */
+bool grid_log_init(const i_gdc_t *ptGDC, grid_rect_t tRegion)
+{
+    if ((NULL == ptGDC) || grid_rect_is_empty(tRegion)) {
+        return false;
+    } else if (NULL == ptGDC->Draw) {
+        //! a message is drawn as one batch
+        return false;
+    }
+
+    s_tRegion = tRegion;
+    s_chRow = 0;
+    s_ptGDC = ptGDC;
+
+    return true;
+}
+
+/*! \brief take a free slot for a message
+ *! \param none
+ *! \return the slot, NULL for the log is full
+ */
+static grid_log_msg_t *grid_log_take(void)
+{
+    grid_log_msg_t *ptMsg = NULL;
+
+    SAFE_ATOM_CODE(
+        if ((uint8_t)(s_chTail - s_chHead) < GRID_LOG_MSG_COUNT) {
+            ptMsg = &s_tMessage[s_chTail & GRID_LOG_MASK];
+            ptMsg->chStatus = GRID_LOG_MSG_FILLING;
+            s_chTail++;
+        } else {
+            s_wDropped++;
+        }
+    )
+
+    return ptMsg;
+}
+
+/*! \brief append a copy of a message, it never waits and could be called in
+ *!        any ISR, even before grid_log_init()
+ *! \param pchString message buffer
+ *! \param hwSize message length, it is cut to GRID_LOG_MSG_SIZE
+ *! \retval true the message is appended
+ *! \retval false the log is full, the message is counted as dropped
+ */
+bool grid_log_post(const uint8_t *pchString, uint_fast16_t hwSize)
+{
+    grid_log_msg_t *ptMsg;
+    uint_fast8_t chIndex;
+
+    if ((NULL == pchString) && (0 != hwSize)) {
+        return false;
+    }
+    ptMsg = grid_log_take();
+    if (NULL == ptMsg) {
+        return false;
+    }
+
+    hwSize = MIN(hwSize, GRID_LOG_MSG_SIZE);
+    for (chIndex = 0; chIndex < hwSize; chIndex++) {
+        ptMsg->chPayload[chIndex] = pchString[chIndex];
+    }
+    ptMsg->pchString = ptMsg->chPayload;
+    ptMsg->chSize = hwSize;
+    ptMsg->chStatus = GRID_LOG_MSG_READY;
+
+    return true;
+}
+
+/*! \brief append a message by reference, it never waits and could be called
+ *!        in any ISR, even before grid_log_init()
+ *! \param pchString message which is kept until it is shown, e.g. a constant
+ *! \param hwSize message length, 255 at most
+ *! \retval true the message is appended
+ *! \retval false the log is full, the message is counted as dropped
+ */
+bool grid_log_post_static(const uint8_t *pchString, uint_fast16_t hwSize)
+{
+    grid_log_msg_t *ptMsg;
+
+    if ((NULL == pchString) && (0 != hwSize)) {
+        return false;
+    }
+    ptMsg = grid_log_take();
+    if (NULL == ptMsg) {
+        return false;
+    }
+
+    ptMsg->pchString = pchString;
+    ptMsg->chSize = MIN(hwSize, 0xFF);
+    ptMsg->chStatus = GRID_LOG_MSG_READY;
+
+    return true;
+}
+
+/*! \brief get the number of messages dropped because the log was full
+ *! \param bReset whether reset the counter
+ *! \return the number of dropped messages
+ */
+uint32_t grid_log_get_dropped(bool bReset)
+{
+    uint32_t wDropped;
+
+    SAFE_ATOM_CODE(
+        wDropped = s_wDropped;
+        if (bReset) {
+            s_wDropped = 0;
+        }
+    )
+
+    return wDropped;
+}
+
+/*! \brief draw the messages appended, it could be the routine of a low 
+ *!        priority scheduler task
+ *! \param pArg not used
+ *! \retval fsm_rt_on_going some messages are not shown yet
+ *! \retval fsm_rt_cpl all messages are shown
+ */
+fsm_rt_t grid_log_task(void *pArg)
+{
+    static coroutine_t s_tTask = 0;
+    //! MOVE, TEXT and FILL the rest of the row
+    NO_INIT static grid_draw_t s_tCommand[3];
+    NO_INIT static grid_log_msg_t *s_ptMsg;
+
+    if (NULL == s_ptGDC) {
+        return fsm_rt_cpl;
+    }
+
+    TASK_BEGIN(s_tTask)
+        while (s_chHead != s_chTail) {
+            s_ptMsg = &s_tMessage[s_chHead & GRID_LOG_MASK];
+            //! the ISR filling it is interrupted
+            AWAIT(GRID_LOG_MSG_READY == s_ptMsg->chStatus);
+
+            do {
+                uint8_t chSize = MIN(s_ptMsg->chSize, s_tRegion.chWidth);
+                grid_t tLine;
+
+                tLine.chX = s_tRegion.chX;
+                tLine.chY = s_tRegion.chY + s_tRegion.chHeight - 1 - s_chRow;
+
+                s_tCommand[0].chCommand = GRID_DRAW_MOVE;
+                s_tCommand[0].tGrid = tLine;
+                s_tCommand[1].chCommand = GRID_DRAW_TEXT;
+                s_tCommand[1].Text.pchString = s_ptMsg->pchString;
+                s_tCommand[1].Text.hwSize = chSize;
+                s_tCommand[2].chCommand = GRID_DRAW_FILL;
+                s_tCommand[2].Fill.tRect.chX = tLine.chX + chSize;
+                s_tCommand[2].Fill.tRect.chY = tLine.chY;
+                s_tCommand[2].Fill.tRect.chWidth = s_tRegion.chWidth - chSize;
+                s_tCommand[2].Fill.tRect.chHeight = 1;
+                s_tCommand[2].Fill.chChar = ' ';
+            } while (false);
+
+            //! a message failed to draw is dropped as well
+            AWAIT(fsm_rt_on_going != s_ptGDC->Draw(s_tCommand, UBOUND(s_tCommand)));
+
+            if (++s_chRow >= s_tRegion.chHeight) {
+                s_chRow = 0;
+            }
+            s_ptMsg->chStatus = GRID_LOG_MSG_FREE;
+            s_chHead++;
+        }
+    TASK_END()
+}
+
+/*! \brief check whether some messages are not shown yet, it could be the wake
+ *!        condition of the task running grid_log_task()
+ *! \param pTarget not used
+ *! \retval true some messages are waiting
+ *! \retval false no message is waiting
+ */
+bool grid_log_is_pending(void *pTarget)
+{
+    return (s_chHead != s_chTail) && (NULL != s_ptGDC);
+}
+
+#endif  /* USE_SERVICE_GUI_TGUI == ENABLED */
+
+/* EOF */
@@ -0,0 +1,89 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __TGUI_GRID_LOG_H__
+#define __TGUI_GRID_LOG_H__
+
+/*============================ INCLUDES ======================================*/
+#include ".\app_cfg.h"
+
+#if USE_SERVICE_GUI_TGUI == ENABLED
+#include "..\interface.h"
+
+/*============================ MACROS ========================================*/
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+/*! \brief set where the log is shown, every message takes a row of the
+ *!        region from the top and the oldest row is reused when it is full
+ *! \param ptGDC the grid drawing context
+ *! \param tRegion the log area
+ *! \retval true the log is ready
+ *! \retval false invalid parameter or the context has no Draw
+ */
+extern bool grid_log_init(const i_gdc_t *ptGDC, grid_rect_t tRegion);
+
+/*! \brief append a copy of a message, it never waits and could be called in
+ *!        any ISR, even before grid_log_init()
+ *! \param pchString message buffer
+ *! \param hwSize message length, it is cut to GRID_LOG_MSG_SIZE
+ *! \retval true the message is appended
+ *! \retval false the log is full, the message is counted as dropped
+ */
+extern bool grid_log_post(const uint8_t *pchString, uint_fast16_t hwSize);
+
+/*! \brief append a message by reference, it never waits and could be called
+ *!        in any ISR, even before grid_log_init()
+ *! \param pchString message which is kept until it is shown, e.g. a constant
+ *! \param hwSize message length, 255 at most
+ *! \retval true the message is appended
+ *! \retval false the log is full, the message is counted as dropped
+ */
+extern bool grid_log_post_static(const uint8_t *pchString, uint_fast16_t hwSize);
+
+/*! \brief get the number of messages dropped because the log was full
+ *! \param bReset whether reset the counter
+ *! \return the number of dropped messages
+ */
+extern uint32_t grid_log_get_dropped(bool bReset);
+
+/*! \brief draw the messages appended, it could be the routine of a low 
+ *!        priority scheduler task
+ *! \param pArg not used
+ *! \retval fsm_rt_on_going some messages are not shown yet
+ *! \retval fsm_rt_cpl all messages are shown
+ */
+extern fsm_rt_t grid_log_task(void *pArg);
+
+/*! \brief check whether some messages are not shown yet, it could be the wake
+ *!        condition of the task running grid_log_task()
+ *! \param pTarget not used
+ *! \retval true some messages are waiting
+ *! \retval false no message is waiting
+ */
+extern bool grid_log_is_pending(void *pTarget);
+
+#endif  /* USE_SERVICE_GUI_TGUI == ENABLED */
+
+#endif  /* __TGUI_GRID_LOG_H__ */
+
+/* EOF */
@@ -5,6 +5,8 @@
 
 #if USE_SERVICE_GUI_TGUI == ENABLED
 #include "..\interface.h"
+#include "..\grid.h"
+#include "..\..\trace\trace.h"
 
 /*============================ MACROS ========================================*/
 #define TGUI_TERMINAL_CLEAR_CODE	    (0x0C)
@@ -13,8 +15,27 @@
 #define WIDTH                           (80)
 #define HEIGHT                          (23)
 
-// termianal write byte
-#ifndef TGUI_TERMINAL_WRITE_BYTE
+//! the top left corner of the screen, where the device cursor goes after clear
+#define HOME                            {.chX = 0, .chY = HEIGHT - 1}
+
+// nested viewport levels, the whole screen is not counted
+#ifndef TGUI_TERMINAL_VIEWPORT_DEPTH
+#   define TGUI_TERMINAL_VIEWPORT_DEPTH (4)
+#endif
+
+// termianal write byte, or write block when output is double buffered, or
+// encode into a tx pipe
+#if defined(TGUI_TERMINAL_TX_PIPE)
+//! TGUI_TERMINAL_TX_PIPE is the tx_pipe_t object, escape sequences are built
+//! in the ring directly, so it should hold 25 bytes at least
+#elif defined(TGUI_TERMINAL_TX_BUFFER_SIZE)
+//! TGUI_TERMINAL_WRITE_BLOCK(__BUFFER, __SIZE) starts transmitting a block by
+//! DMA or TX ISR and returns true when the transmission is started, the driver
+//! reports completion through terminal_tx_cpl() registered to its delegate
+#   ifndef TGUI_TERMINAL_WRITE_BLOCK
+#       error No defined TGUI_TERMINAL_WRITE_BLOCK
+#   endif
+#elif !defined(TGUI_TERMINAL_WRITE_BYTE)
 #   error No defined TGUI_TERMINAL_WRITE_BYTE
 #endif
 
@@ -33,6 +54,14 @@ typedef enum {
 } em_ter_status_t;
 //! @}
 
+//! \name terminal viewport
+//! @{
+typedef struct {
+    grid_t          tOrigin;            //!< viewport position on the screen
+    grid_rect_t     tClip;              //!< visible part on the screen
+} ter_viewport_t;
+//! @}
+
 /*============================ PROTOTYPES ====================================*/
 /*! \brief set current cursor position
  *! \param tGrid cursor position
@@ -45,6 +74,7 @@ static fsm_rt_t terminal_set_grid(grid_t tGrid);
  *! \param tGrid cursor position
  *! \retval fsm_rt_on_going set grid finish
  *! \retval fsm_rt_cpl set grid on going
+ *! \retval fsm_rt_err invalid report from the terminal
  */
 static fsm_rt_t terminal_get_grid(grid_t *ptGrid);
 
@@ -75,6 +105,21 @@ static fsm_rt_t terminal_set_brush(grid_brush_t tBrush);
  */
 static grid_brush_t terminal_get_brush(void);
 
+/*! \brief enter a viewport inside the current one, following drawing operations
+ *!        are relative to the viewport and clipped by it
+ *! \param tViewport viewport position and size inside the current viewport
+ *! \retval true viewport is entered
+ *! \retval false too many nested viewports
+ */
+static bool terminal_push_viewport(grid_rect_t tViewport);
+
+/*! \brief leave current viewport
+ *! \param none
+ *! \retval true viewport is left
+ *! \retval false no viewport to leave
+ */
+static bool terminal_pop_viewport(void);
+
 /*! \brief terminal clear
  *! \param none
  *! \retval fsm_rt_on_going terminal clear on going
@@ -82,13 +127,36 @@ static grid_brush_t terminal_get_brush(void);
  */
 static fsm_rt_t terminal_clear(void);
 
-/*! \brief terminal print
- *! \param none
+/*! \brief terminal print, the string is cut by current viewport
+ *! \param pchString string buffer
+ *! \param hwSize string length
  *! \retval fsm_rt_on_going terminal print on going
  *! \retval fsm_rt_cpl terminal print finish
  */
 static fsm_rt_t terminal_print(uint8_t *pchString, uint_fast16_t hwSize);
 
+/*! \brief move the content of full-width rows with scroll region and
+ *!        insert / delete line
+ *! \param tRegion rows to scroll, it should be as wide as the screen
+ *! \param chOffset content movement along y, rows exposed are blank
+ *! \retval fsm_rt_on_going terminal scroll on going
+ *! \retval fsm_rt_cpl terminal scroll finish
+ *! \retval fsm_rt_err the region is not scrollable
+ */
+static fsm_rt_t terminal_scroll(grid_rect_t tRegion, int_fast8_t chOffset);
+
+/*! \brief execute a batch of draw commands with the terminal locked once,
+ *!        cursor movements are only sent when something visible follows
+ *!        them and a display attribute is sent before the next visible
+ *!        output, or at the end of the batch so later prints use it
+ *! \param ptCommands command array
+ *! \param hwCount number of commands
+ *! \retval fsm_rt_on_going terminal draw on going
+ *! \retval fsm_rt_cpl terminal draw finish
+ *! \retval fsm_rt_err invalid command, nothing is drawn
+ */
+static fsm_rt_t terminal_draw(const grid_draw_t *ptCommands, uint_fast16_t hwCount);
+
 /*============================ GLOBAL VARIABLES ==============================*/
 //! \brief terminal object
 const i_gdc_t terminal = {
@@ -106,30 +174,245 @@ const i_gdc_t terminal = {
         .Set = terminal_set_brush,
         .Get = terminal_get_brush,
     },
+    .Viewport = {
+        .Push = terminal_push_viewport,
+        .Pop = terminal_pop_viewport,
+    },
     .Clear = terminal_clear,
     .Print = terminal_print,
+    .Scroll = terminal_scroll,
+    .Draw = terminal_draw,
 };
 
 /*============================ LOCAL VARIABLES ===============================*/
 //! grid brush
 static grid_brush_t s_tCurrentGridBrush;
 
+#ifndef TGUI_TERMINAL_TX_PIPE
 //! terminal exchange buffer
-static uint8_t s_chSend[8] = {
-    ASCII_ESC, '[',
-};
+static uint8_t s_chSend[24];
+#endif
 
 //! terminal lock status
 static em_ter_status_t s_tCurrentStatus = TER_READY_IDLE;
 
+//! viewport stack, the bottom one is the whole screen
+static ter_viewport_t s_tViewportStack[TGUI_TERMINAL_VIEWPORT_DEPTH + 1] = {
+    {
+        .tClip = {
+            .chWidth = WIDTH,
+            .chHeight = HEIGHT,
+        },
+    },
+};
+
+//! current viewport
+static ter_viewport_t *s_ptViewport = s_tViewportStack;
+
+//! cursor position on the screen, it could be outside of the screen
+static grid_t s_tCursor = HOME;
+static grid_t s_tSavedCursor;
+
+//! cursor position of the device
+static grid_t s_tDeviceCursor;
+static grid_t s_tSavedDeviceCursor;
+static bool s_bDeviceCursorValid = false;
+static bool s_bSavedDeviceCursorValid = false;
+
+//! whether s_tCurrentGridBrush is what the device uses
+static bool s_bBrushValid = false;
+
+#ifdef TGUI_TERMINAL_TX_BUFFER_SIZE
+//! output buffers, one is filled while the other one is transmitted
+static uint8_t s_chTXBuffer[2][TGUI_TERMINAL_TX_BUFFER_SIZE];
+static volatile uint8_t s_chFillIndex = 0;
+static volatile uint_fast16_t s_hwFillSize = 0;
+static volatile bool s_bTXBusy = false;
+//! the encoder is copying into the fill buffer, it kicks when done
+static volatile bool s_bFilling = false;
+#endif
+
 /*============================ IMPLEMENTATION ================================*/
 
-#define TER_STREAM_RESET_FSM()                  \
-    do {                                        \
-        s_tState = TER_STREAM_START;            \
-    } while(false)
+#ifdef TGUI_TERMINAL_TX_BUFFER_SIZE
+/*! \brief hand the filled buffer to the driver when the other one is free,
+ *!        it could be called by the encoder and by the transmit complete ISR
+ *! \param none
+ *! \return none
+ */
+static void ter_tx_kick(void)
+{
+    uint8_t *pchBlock;
+    uint_fast16_t hwSize;
+
+    SAFE_ATOM_CODE(
+        if (s_bTXBusy || s_bFilling || (0 == s_hwFillSize)) {
+            EXIT_SAFE_ATOM_CODE();
+            return ;
+        }
+        s_bTXBusy = true;
+        pchBlock = s_chTXBuffer[s_chFillIndex];
+        hwSize = s_hwFillSize;
+        s_chFillIndex ^= 1;
+        s_hwFillSize = 0;
+    )
+
+    if (!TGUI_TERMINAL_WRITE_BLOCK(pchBlock, hwSize)) {
+        //! driver refused, the block is retried by the next write or poll
+        SAFE_ATOM_CODE(
+            s_chFillIndex ^= 1;
+            s_hwFillSize = hwSize;
+            s_bTXBusy = false;
+        )
+    }
+}
+
+/*! \brief reserve the free space of the fill buffer
+ *! \param hwSize number of bytes wanted
+ *! \param phwCount number of bytes reserved
+ *! \return the space reserved, commit it with ter_tx_commit()
+ */
+static uint8_t *ter_tx_reserve(uint_fast16_t hwSize, uint_fast16_t *phwCount)
+{
+    uint8_t *pchFill;
+
+    SAFE_ATOM_CODE(
+        //! the buffer is not handed to the driver until it is committed
+        s_bFilling = true;
+        *phwCount = MIN(hwSize, TGUI_TERMINAL_TX_BUFFER_SIZE - s_hwFillSize);
+        pchFill = &s_chTXBuffer[s_chFillIndex][s_hwFillSize];
+    )
+
+    return pchFill;
+}
+
+/*! \brief commit the bytes written in the space from ter_tx_reserve()
+ *! \param hwCount number of bytes written
+ *! \return none
+ */
+static void ter_tx_commit(uint_fast16_t hwCount)
+{
+    SAFE_ATOM_CODE(
+        s_hwFillSize += hwCount;
+        s_bFilling = false;
+    )
+    ter_tx_kick();
+}
+
+/*! \brief retry the output the driver refused, e.g. the tail of the last
+ *!        operation. It could be the routine of a scheduler task.
+ *! \param pArg not used
+ *! \retval fsm_rt_on_going some output is not handed to the driver yet
+ *! \retval fsm_rt_cpl all output is handed to the driver
+ */
+fsm_rt_t terminal_tx_poll(void *pArg)
+{
+    ter_tx_kick();
+
+    return (0 == s_hwFillSize) ? fsm_rt_cpl : fsm_rt_on_going;
+}
+
+/*! \brief transmit complete handler, register it to the transmit complete
+ *!        delegate of the driver
+ *! \param pArg not used
+ *! \param pParam not used
+ *! \return fsm_rt_cpl
+ */
+fsm_rt_t terminal_tx_cpl(void *pArg, void *pParam)
+{
+    s_bTXBusy = false;
+    //! the buffer filled meanwhile goes out at once
+    ter_tx_kick();
+
+    return fsm_rt_cpl;
+}
+#endif
+
+/*! \brief write bytes to the terminal
+ *! \param pchStream bytes to write
+ *! \param hwSize number of bytes
+ *! \return the number of bytes accepted
+ */
+static uint_fast16_t ter_write(const uint8_t *pchStream, uint_fast16_t hwSize)
+{
+#if defined(TGUI_TERMINAL_TX_PIPE)
+    return tx_pipe_write(&(TGUI_TERMINAL_TX_PIPE), pchStream, hwSize);
+#elif defined(TGUI_TERMINAL_TX_BUFFER_SIZE)
+    uint_fast16_t hwCount;
+    uint8_t *pchFill = ter_tx_reserve(hwSize, &hwCount);
+
+    //! the encoder fills one buffer while the driver drains the other one
+    for (hwSize = hwCount; hwSize--;) {
+        *pchFill++ = *pchStream++;
+    }
+    ter_tx_commit(hwCount);
+
+    return hwCount;
+#else
+    if ((0 != hwSize) && TGUI_TERMINAL_WRITE_BYTE(*pchStream)) {
+        return 1;
+    }
+
+    return 0;
+#endif
+}
+
+/*! \brief write a character several times to the terminal
+ *! \param chChar character
+ *! \param hwSize number of times
+ *! \return the number of characters accepted
+ */
+static uint_fast16_t ter_fill(uint8_t chChar, uint_fast16_t hwSize)
+{
+#if defined(TGUI_TERMINAL_TX_PIPE)
+    uint_fast16_t hwSpan, hwCount;
+    uint8_t *pchSpan = tx_pipe_reserve(&(TGUI_TERMINAL_TX_PIPE), 1, &hwSpan);
+
+    if ((NULL == pchSpan) || (0 == hwSize)) {
+        return 0;
+    }
+    hwSpan = MIN(hwSpan, hwSize);
+    for (hwCount = 0; hwCount < hwSpan; hwCount++) {
+        pchSpan[hwCount] = chChar;
+    }
+    tx_pipe_commit(&(TGUI_TERMINAL_TX_PIPE), pchSpan, hwSpan);
+
+    return hwSpan;
+#elif defined(TGUI_TERMINAL_TX_BUFFER_SIZE)
+    uint_fast16_t hwCount, n;
+    uint8_t *pchFill = ter_tx_reserve(hwSize, &hwCount);
+
+    for (n = 0; n < hwCount; n++) {
+        pchFill[n] = chChar;
+    }
+    ter_tx_commit(hwCount);
+
+    return hwCount;
+#else
+    return ter_write(&chChar, MIN(hwSize, 1));
+#endif
+}
+
+/*! \brief get the buffer an escape sequence is built in
+ *! \param chSize maximum sequence length, 24 at most
+ *! \return the buffer, NULL for no space in the tx pipe now
+ */
+static uint8_t *ter_code_buffer(uint8_t chSize)
+{
+#if defined(TGUI_TERMINAL_TX_PIPE)
+    //! the sequence is built in the ring and sent without copying
+    return tx_pipe_reserve(&(TGUI_TERMINAL_TX_PIPE), chSize, NULL);
+#elif defined(TGUI_TERMINAL_TX_BUFFER_SIZE)
+    //! a new operation retries the output the driver refused
+    ter_tx_kick();
+    return s_chSend;
+#else
+    return s_chSend;
+#endif
+}
 
 /*! \brief terminal stream send with external interface TGUI_TERMINAL_WRITE_BYTE()
+ *!        or the double buffered output
  *!
  *! \param pchStream output stream buffer
  *! \param wSize stream length
@@ -139,296 +422,318 @@ static em_ter_status_t s_tCurrentStatus = TER_READY_IDLE;
  */
 static fsm_rt_t fsm_ter_stream_exchange(uint8_t *pchStream, uint8_t chSize)
 {
+    static coroutine_t s_tTask = 0;
     NO_INIT static uint8_t *s_pchStream;
     NO_INIT static uint8_t s_chSize;
 
-    static enum {
-        TER_STREAM_START                = 0,
-        TER_STREAM_SEND
-    } s_tState = TER_STREAM_START;
-
-    switch (s_tState) {
-        case TER_STREAM_START:              //!< FSM start
-            //! check parameter
-            if ((NULL == pchStream) || (0 == chSize)) {
-                return fsm_rt_cpl;          //!< doing nothing at all
-            } else {
-                //! read & write
-                s_pchStream = pchStream;
-                s_chSize = chSize;            //!< initialize size
-                s_tState = TER_STREAM_SEND;
-            }
-            break;
-
-        case TER_STREAM_SEND: {             //!< FSM start
-            if (TGUI_TERMINAL_WRITE_BYTE(*s_pchStream)) {
-                //! success
-                s_pchStream++;
-                if (0 == --s_chSize) {
-                    TER_STREAM_RESET_FSM();
-                    return fsm_rt_cpl;
-                }
-            }
-            break;
+    TASK_BEGIN(s_tTask)
+        //! check parameter
+        if ((NULL == pchStream) || (0 == chSize)) {
+            TASK_RETURN(fsm_rt_cpl);        //!< doing nothing at all
         }
-    }
+        s_pchStream = pchStream;
+        s_chSize = chSize;                  //!< initialize size
+
+        do {
+            uint8_t chCount;
+            AWAIT(0 != (chCount = ter_write(s_pchStream, s_chSize)));
+            s_pchStream += chCount;
+            s_chSize -= chCount;
+        } while (0 != s_chSize);
+    TASK_END()
+}
 
-    return fsm_rt_on_going;                 //!< state machine keep running
+/*! \brief send an escape sequence built in the buffer from ter_code_buffer()
+ *! \param pchCode escape sequence
+ *! \param chSize sequence length
+ *! \retval fsm_rt_on_going FSM should keep running
+ *! \retval fsm_rt_cpl FSM complete.
+ */
+static fsm_rt_t ter_code_send(uint8_t *pchCode, uint8_t chSize)
+{
+#if defined(TGUI_TERMINAL_TX_PIPE)
+    tx_pipe_commit(&(TGUI_TERMINAL_TX_PIPE), pchCode, chSize);
+    return fsm_rt_cpl;
+#else
+    return fsm_ter_stream_exchange(pchCode, chSize);
+#endif
 }
 
-#define TERMINAL_SET_GRID_RESET()           \
-    do {                                    \
-        s_tState = TERMINAL_SET_GRID_START; \
-    } while(0)
+/*! \brief write a decimal number (0~99) of an escape sequence
+ *! \param pchBuffer output buffer
+ *! \param chValue number
+ *! \return the number of characters written
+ */
+static uint8_t ter_format_number(uint8_t *pchBuffer, uint8_t chValue)
+{
+    if (0 != chValue / 10) {
+        pchBuffer[0] = chValue / 10 + '0';
+        pchBuffer[1] = chValue % 10 + '0';
+        return 2;
+    }
+    pchBuffer[0] = chValue + '0';
 
-#if 0
+    return 1;
+}
 
-/*! \brief set current cursor position
- *! \param tGrid cursor position
- *! \retval fsm_rt_on_going set grid on going
- *! \retval fsm_rt_cpl set grid finish
+/*! \brief build the cursor position sequence
+ *! \param pchBuffer output buffer, 8 bytes at most are written
+ *! \param tGrid cursor position on the screen
+ *! \return sequence length
  */
-static fsm_rt_t terminal_set_grid(grid_t tGrid)
+static uint8_t ter_build_grid_code(uint8_t *pchBuffer, grid_t tGrid)
 {
-    static enum {
-        TERMINAL_SET_GRID_START = 0,
-        TERMINAL_SET_GRID_SEND
-    } s_tState = TERMINAL_SET_GRID_START;
-    
-    switch ( s_tState ) {
-        case TERMINAL_SET_GRID_START:
-
-            SAFE_ATOM_CODE(
-                //! whether system is initialized
-                if (TER_READY_BUSY == s_tCurrentStatus) {
-                    EXIT_SAFE_ATOM_CODE();
-                    return fsm_rt_on_going;
-                }
-                //! set current state
-                s_tCurrentStatus = TER_READY_BUSY;
-            )
+    uint8_t chIndex = 0;
 
-            do {
-                uint8_t chRow = HEIGHT - tGrid.chTop;
-                uint8_t chColumn = tGrid.chLeft;
-
-                s_chSend[2] = ( chRow / 10 ) + '0';
-                s_chSend[3] = ( chRow % 10 ) + '0';
-                s_chSend[4] = ';';
-                s_chSend[5] = ( chColumn / 10 ) + '0';
-                s_chSend[6] = ( chColumn % 10 ) + '1';
-                s_chSend[7] = 'H';
-            } while (false);
+    pchBuffer[chIndex++] = ASCII_ESC;
+    pchBuffer[chIndex++] = '[';
+    chIndex += ter_format_number(&pchBuffer[chIndex], HEIGHT - tGrid.chTop);
+    pchBuffer[chIndex++] = ';';
+    chIndex += ter_format_number(&pchBuffer[chIndex], tGrid.chLeft + 1);
+    pchBuffer[chIndex++] = 'H';
 
-            s_tState = TERMINAL_SET_GRID_SEND;
-            // break;
-
-        case TERMINAL_SET_GRID_SEND:
-            if (fsm_rt_cpl == fsm_ter_stream_exchange(s_chSend, 8)) {
-                SAFE_ATOM_CODE(
-                    //! set idle state
-                    s_tCurrentStatus = TER_READY_IDLE;
-                )
-                TERMINAL_SET_GRID_RESET();
-                return fsm_rt_cpl;
-            }
-            break;
-    }
-    
-    return fsm_rt_on_going;
+    return chIndex;
 }
 
-#else
+/*! \brief build the display attribute sequence
+ *! \param pchBuffer output buffer, 8 bytes are written
+ *! \param tBrush display attribute
+ *! \return sequence length
+ */
+static uint8_t ter_build_brush_code(uint8_t *pchBuffer, grid_brush_t tBrush)
+{
+    pchBuffer[0] = ASCII_ESC;
+    pchBuffer[1] = '[';
+    pchBuffer[2] = '3';
+    pchBuffer[3] = tBrush.tForeground.tValue + '0';
+    pchBuffer[4] = ';';
+    pchBuffer[5] = '4';
+    pchBuffer[6] = tBrush.tBackground.tValue + '0';
+    pchBuffer[7] = 'm';
+
+    return 8;
+}
 
-/*! \brief set current cursor position
- *! \param tGrid cursor position
- *! \retval fsm_rt_on_going set grid on going
- *! \retval fsm_rt_cpl set grid finish
+/*! \brief build the sequence moving the device cursor to a position when it
+ *!        is not there yet
+ *! \param pchBuffer output buffer, 8 bytes at most are written
+ *! \param tGrid target position on the screen
+ *! \return sequence length, 0 for no movement
  */
-static fsm_rt_t terminal_set_grid(grid_t tGrid)
+static uint8_t ter_build_move_code(uint8_t *pchBuffer, grid_t tGrid)
 {
-    static enum {
-        TERMINAL_SET_GRID_START = 0,
-        TERMINAL_SET_GRID_SEND
-    } s_tState = TERMINAL_SET_GRID_START;
-    static uint8_t s_chIndex = 2;
+    if (    s_bDeviceCursorValid
+        &&  (s_tDeviceCursor.chX == tGrid.chX)
+        &&  (s_tDeviceCursor.chY == tGrid.chY)) {
+        return 0;
+    }
+    s_tDeviceCursor = tGrid;
+    s_bDeviceCursorValid = true;
 
-    switch ( s_tState ) {
-        case TERMINAL_SET_GRID_START:
+    return ter_build_grid_code(pchBuffer, tGrid);
+}
 
-            SAFE_ATOM_CODE(
-                //! whether system is initialized
-                if (TER_READY_BUSY == s_tCurrentStatus) {
-                    EXIT_SAFE_ATOM_CODE();
-                    return fsm_rt_on_going;
-                }
-                //! set current state
-                s_tCurrentStatus = TER_READY_BUSY;
-            )
+/*! \brief the device cursor moves right after printing
+ *! \param chSize number of characters printed
+ *! \return none
+ */
+static void ter_advance_device_cursor(uint8_t chSize)
+{
+    s_tDeviceCursor.chX += chSize;
+    s_bDeviceCursorValid = (s_tDeviceCursor.chX < WIDTH);
+}
 
-            do {
-                uint8_t chRow = HEIGHT - tGrid.chTop;
-                uint8_t chColumn = tGrid.chLeft;
-                s_chIndex = 2;
+/*! \brief cut a string printed at the cursor by current viewport, the cursor
+ *!        moves to the end of the string
+ *! \param hwSize string length
+ *! \param ptStart start position of the visible part on the screen
+ *! \param phwOffset offset of the visible part in the string
+ *! \return length of the visible part, 0 for fully clipped
+ */
+static uint8_t ter_clip_span(uint_fast16_t hwSize, grid_t *ptStart, uint_fast16_t *phwOffset)
+{
+    const grid_rect_t *ptClip = &(s_ptViewport->tClip);
+    int_fast32_t nLeft, nRight, nEnd;
+
+    nEnd = (int_fast32_t)s_tCursor.chX + hwSize;
+    nLeft = MAX(s_tCursor.chX, ptClip->chLeft);
+    nRight = MIN(nEnd, ptClip->chLeft + ptClip->chWidth);
+    ptStart->chX = nLeft;
+    ptStart->chY = s_tCursor.chY;
+    *phwOffset = nLeft - s_tCursor.chX;
+    s_tCursor.chX = MIN(nEnd, WIDTH);
+
+    if (    (ptStart->chY < ptClip->chTop)
+        ||  (ptStart->chY >= ptClip->chTop + ptClip->chHeight)
+        ||  (nLeft >= nRight)) {
+        return 0;
+    }
 
-                if (0 != chRow / 10) {
-                    s_chSend[s_chIndex++] = chRow / 10 + '0';
-                }
-                s_chSend[s_chIndex++] = chRow % 10 + '0';
-                s_chSend[s_chIndex++] = ';';
-                if (0 != chColumn / 10) {
-                    s_chSend[s_chIndex++] = chColumn / 10 + '0';
-                }
-                s_chSend[s_chIndex++] = ( chColumn % 10 ) + '1';
-                s_chSend[s_chIndex++] = 'H';
-            } while (false);
+    return nRight - nLeft;
+}
 
-            s_tState = TERMINAL_SET_GRID_SEND;
-            // break;
-
-        case TERMINAL_SET_GRID_SEND:
-            if (fsm_rt_cpl == fsm_ter_stream_exchange(s_chSend, s_chIndex)) {
-                SAFE_ATOM_CODE(
-                    //! set idle state
-                    s_tCurrentStatus = TER_READY_IDLE;
-                )
-                TERMINAL_SET_GRID_RESET();
-                return fsm_rt_cpl;
-            }
-            break;
-    }
+/*! \brief lock the terminal for an operation
+ *! \param none
+ *! \retval true the terminal is locked
+ *! \retval false the terminal is busy
+ */
+static bool ter_lock(void)
+{
+    bool bLocked = false;
+
+    SAFE_ATOM_CODE(
+        //! whether system is initialized
+        if (TER_READY_IDLE == s_tCurrentStatus) {
+            //! set current state
+            s_tCurrentStatus = TER_READY_BUSY;
+            bLocked = true;
+        }
+    )
 
-    return fsm_rt_on_going;
+    return bLocked;
 }
 
-#endif
+/*! \brief unlock the terminal, it is the cleanup of every locked operation
+ *! \param none
+ *! \return none
+ */
+static void ter_unlock(void)
+{
+    SAFE_ATOM_CODE(
+        //! set idle state
+        s_tCurrentStatus = TER_READY_IDLE;
+    )
+}
 
-#define TERMINAL_GET_GRID_RESET()           \
-    do {                                    \
-        s_tState = TERMINAL_GET_GRID_START; \
-    } while(0)
+/*! \brief set current cursor position
+ *! \param tGrid cursor position
+ *! \retval fsm_rt_on_going set grid on going
+ *! \retval fsm_rt_cpl set grid finish
+ */
+static fsm_rt_t ter_set_grid(grid_t tGrid)
+{
+    static coroutine_t s_tTask = 0;
+    NO_INIT static uint8_t s_chIndex;
+    NO_INIT static uint8_t *s_pchCode;
+
+    TASK_BEGIN(s_tTask)
+        //! the viewport and the cursor only change with the terminal locked
+        AWAIT(ter_lock());
+
+        //! translate to the screen
+        tGrid.chX += s_ptViewport->tOrigin.chX;
+        tGrid.chY += s_ptViewport->tOrigin.chY;
+        s_tCursor = tGrid;
+
+        if (!grid_rect_contains(s_ptViewport->tClip, tGrid)) {
+            //! nothing to send, print moves the cursor when necessary
+            TASK_EXIT(fsm_rt_cpl);
+        }
+
+        //! wait for the output
+        AWAIT(NULL != (s_pchCode = ter_code_buffer(8)));
+        s_chIndex = ter_build_move_code(s_pchCode, s_tCursor);
+        AWAIT_FSM(ter_code_send(s_pchCode, s_chIndex));
+    TASK_END(
+        ter_unlock();
+    )
+}
+
+/*! \brief set current cursor position
+ *! \param tGrid cursor position
+ *! \retval fsm_rt_on_going set grid on going
+ *! \retval fsm_rt_cpl set grid finish
+ */
+static fsm_rt_t terminal_set_grid(grid_t tGrid)
+{
+    //! the waits between polls are not counted
+    TGUI_TRACE_RESUME(TGUI_TRACE_SET_GRID);
+    return TGUI_TRACE_PAUSE(TGUI_TRACE_SET_GRID, ter_set_grid(tGrid));
+}
 
 /*! \brief get current cursor position
  *! \param tGrid cursor position
  *! \retval fsm_rt_on_going set grid finish
  *! \retval fsm_rt_cpl set grid on going
+ *! \retval fsm_rt_err invalid report from the terminal
  */
 static fsm_rt_t terminal_get_grid(grid_t *ptGrid)
 {
-    static enum {
-        TERMINAL_GET_GRID_START = 0,
-        TERMINAL_GET_GRID_SEND,
-        TERMINAL_GET_GRID_RECEIVE,
-        TERMINAL_GET_GRID_CHECK
-    } s_tState = TERMINAL_GET_GRID_START;
-    
+    static coroutine_t s_tTask = 0;
     NO_INIT static uint8_t s_chReceiveCode[8];
     NO_INIT static uint8_t s_chReceiveCnt;
+    NO_INIT static uint8_t s_chReceive;
+    NO_INIT static uint8_t *s_pchCode;
+    NO_INIT static grid_t *s_ptGrid;
 
-	if ( NULL == ptGrid ) {
-		return fsm_rt_err;
-	}
-    
-    switch ( s_tState ) {
-        case TERMINAL_GET_GRID_START:
-            SAFE_ATOM_CODE(
-                //! whether system is initialized
-                if (TER_READY_BUSY == s_tCurrentStatus) {
-                    EXIT_SAFE_ATOM_CODE();
-                    return fsm_rt_on_going;
-                }
-                //! set current state
-                s_tCurrentStatus = TER_READY_BUSY;
-            )
-
-            s_chSend[2] = '6';
-            s_chSend[3] = 'n';
-            s_tState = TERMINAL_GET_GRID_SEND;
-            // break;
-
-        case TERMINAL_GET_GRID_SEND:
-            if (fsm_rt_cpl == fsm_ter_stream_exchange(s_chSend, 4)) {
-                s_chReceiveCnt = 0;
-                s_tState = TERMINAL_GET_GRID_RECEIVE;
+    TASK_BEGIN(s_tTask)
+        if (NULL == ptGrid) {
+            TASK_RETURN(fsm_rt_err);
+        }
+        s_ptGrid = ptGrid;
+        AWAIT(ter_lock());
+        //! wait for the output
+        AWAIT(NULL != (s_pchCode = ter_code_buffer(4)));
+
+        s_pchCode[0] = ASCII_ESC;
+        s_pchCode[1] = '[';
+        s_pchCode[2] = '6';
+        s_pchCode[3] = 'n';
+        AWAIT_FSM(ter_code_send(s_pchCode, 4));
+
+        //! ESC[row;colR
+        s_chReceiveCnt = 0;
+        do {
+            AWAIT(TGUI_TERMINAL_READ_BYTE(&s_chReceive));
+            if (s_chReceiveCnt >= sizeof(s_chReceiveCode)) {
+                TASK_EXIT(fsm_rt_err);
             }
-            break;
-
-        case TERMINAL_GET_GRID_RECEIVE: {
-                uint8_t chTemp;
-                if ( TGUI_TERMINAL_READ_BYTE(&chTemp) ) {
-                    s_chReceiveCode[s_chReceiveCnt] = chTemp;
-                    s_chReceiveCnt++;
-                    if ( s_chReceiveCnt > 8 ) {
-                        SAFE_ATOM_CODE(
-                            //! set idle state
-                            s_tCurrentStatus = TER_READY_IDLE;
-                        )
-                        return fsm_rt_err;
-                    }
-                    if ( 'R' == chTemp ) {
-                        s_tState = TERMINAL_GET_GRID_CHECK;
-                    }
+            s_chReceiveCode[s_chReceiveCnt++] = s_chReceive;
+        } while ('R' != s_chReceive);
+
+        do {
+            int_fast8_t chRow;
+            int_fast8_t chColumn;
+
+            if ( ';' == s_chReceiveCode[3] ) {
+                chRow = HEIGHT - (s_chReceiveCode[2] - '0');
+                if ( 'R' == s_chReceiveCode[5] ) {
+                    chColumn = s_chReceiveCode[4] - '1';
+                } else if ( 'R' == s_chReceiveCode[6] ) {
+                    chColumn = ( s_chReceiveCode[4] - '0' ) * 10;
+                    chColumn += ( s_chReceiveCode[5] - '1' );
+                } else {
+                    TASK_EXIT(fsm_rt_err);
                 }
-            }
-            break;
-
-        case TERMINAL_GET_GRID_CHECK: {
-                int_fast8_t chRow;
-                int_fast8_t chColumn;
-
-                if ( ';' == s_chReceiveCode[3] ) {
-                    chRow = HEIGHT - (s_chReceiveCode[2] - '0');
-                    if ( 'R' == s_chReceiveCode[5] ) {
-                        chColumn = s_chReceiveCode[4] - '1';
-                    } else if ( 'R' == s_chReceiveCode[6] ) {
-                        chColumn = ( s_chReceiveCode[4] - '0' ) * 10;
-                        chColumn += ( s_chReceiveCode[5] - '1' );
-                    } else {
-                        SAFE_ATOM_CODE(
-                            //! set idle state
-                            s_tCurrentStatus = TER_READY_IDLE;
-                        )
-                        return fsm_rt_err;
-                    }
-                } else if ( ';' == s_chReceiveCode[4] ) {
-                    chRow = ( s_chReceiveCode[2] - '0' ) * 10;
-                    chRow += ( s_chReceiveCode[3] - '0' );
-                    chRow = HEIGHT - chRow;
-                    if ( 'R' == s_chReceiveCode[6] ) {
-                        chColumn = s_chReceiveCode[5] - '1';
-                    } else if ( 'R' == s_chReceiveCode[7] ) {
-                        chColumn = ( s_chReceiveCode[5] - '0' ) * 10;
-                        chColumn += ( s_chReceiveCode[6] - '1' );
-                    } else {
-                        SAFE_ATOM_CODE(
-                            //! set idle state
-                            s_tCurrentStatus = TER_READY_IDLE;
-                        )
-                        return fsm_rt_err;
-                    }
+            } else if ( ';' == s_chReceiveCode[4] ) {
+                chRow = ( s_chReceiveCode[2] - '0' ) * 10;
+                chRow += ( s_chReceiveCode[3] - '0' );
+                chRow = HEIGHT - chRow;
+                if ( 'R' == s_chReceiveCode[6] ) {
+                    chColumn = s_chReceiveCode[5] - '1';
+                } else if ( 'R' == s_chReceiveCode[7] ) {
+                    chColumn = ( s_chReceiveCode[5] - '0' ) * 10;
+                    chColumn += ( s_chReceiveCode[6] - '1' );
                 } else {
-                    return fsm_rt_err;
+                    TASK_EXIT(fsm_rt_err);
                 }
-                ptGrid->chTop = chRow;
-                ptGrid->chLeft = chColumn;
-
-                SAFE_ATOM_CODE(
-                    //! set idle state
-                    s_tCurrentStatus = TER_READY_IDLE;
-                )
-                TERMINAL_GET_GRID_RESET();
-                return fsm_rt_cpl;
-                // break;
+            } else {
+                TASK_EXIT(fsm_rt_err);
             }
-    }
-    
-    return fsm_rt_on_going;
+            s_tDeviceCursor.chTop = chRow;
+            s_tDeviceCursor.chLeft = chColumn;
+            s_bDeviceCursorValid = true;
+            s_tCursor = s_tDeviceCursor;
+
+            //! translate to current viewport
+            s_ptGrid->chTop = chRow - s_ptViewport->tOrigin.chY;
+            s_ptGrid->chLeft = chColumn - s_ptViewport->tOrigin.chX;
+        } while (false);
+    TASK_END(
+        ter_unlock();
+    )
 }
 
-#define TERMINAL_SAVE_CURRENT_RESET()           \
-    do {                                        \
-        s_tState = TERMINAL_SAVE_CURRENT_START; \
-    } while(0)    
 /*! \brief save current cursor position
  *! \param none
  *! \retval fsm_rt_on_going save grid on going
@@ -436,47 +741,26 @@ static fsm_rt_t terminal_get_grid(grid_t *ptGrid)
  */
 static fsm_rt_t terminal_save_current(void)
 {
-    static enum {
-        TERMINAL_SAVE_CURRENT_START = 0,
-        TERMINAL_SAVE_CURRENT_SEND
-    } s_tState = TERMINAL_SAVE_CURRENT_START;
-    
-    switch ( s_tState ) {
-        case TERMINAL_SAVE_CURRENT_START:
-            SAFE_ATOM_CODE(
-                //! whether system is initialized
-                if (TER_READY_BUSY == s_tCurrentStatus) {
-                    EXIT_SAFE_ATOM_CODE();
-                    return fsm_rt_on_going;
-                }
-                //! set current state
-                s_tCurrentStatus = TER_READY_BUSY;
-            )
-            s_chSend[2] = 's';
-            s_tState = TERMINAL_SAVE_CURRENT_SEND;
-            // break;
-
-        case TERMINAL_SAVE_CURRENT_SEND:
-            if (fsm_rt_cpl == fsm_ter_stream_exchange(s_chSend, 3)) {
-                SAFE_ATOM_CODE(
-                    //! set idle state
-                    s_tCurrentStatus = TER_READY_IDLE;
-                )
-                TERMINAL_SAVE_CURRENT_RESET();
-                return fsm_rt_cpl;
-            }
-            break;
-    }
-    
-    return fsm_rt_on_going;
+    static coroutine_t s_tTask = 0;
+    NO_INIT static uint8_t *s_pchCode;
+
+    TASK_BEGIN(s_tTask)
+        AWAIT(ter_lock());
+        //! wait for the output
+        AWAIT(NULL != (s_pchCode = ter_code_buffer(3)));
+
+        s_pchCode[0] = ASCII_ESC;
+        s_pchCode[1] = '[';
+        s_pchCode[2] = 's';
+        s_tSavedCursor = s_tCursor;
+        s_tSavedDeviceCursor = s_tDeviceCursor;
+        s_bSavedDeviceCursorValid = s_bDeviceCursorValid;
+        AWAIT_FSM(ter_code_send(s_pchCode, 3));
+    TASK_END(
+        ter_unlock();
+    )
 }
 
-
-#define TERMINAL_RESUME_RESET()             \
-    do {                                    \
-        s_tState = TERMINAL_RESUME_START;   \
-    } while(0)    
-
 /*! \brief resume current cursor position
  *! \param none
  *! \retval fsm_rt_on_going set grid on going
@@ -484,45 +768,56 @@ static fsm_rt_t terminal_save_current(void)
  */
 static fsm_rt_t terminal_resume(void)
 {
-    static enum {
-        TERMINAL_RESUME_START = 0,
-        TERMINAL_RESUME_SEND
-    } s_tState = TERMINAL_RESUME_START;
-
-    switch ( s_tState ) {
-        case TERMINAL_RESUME_START:
-            SAFE_ATOM_CODE(
-                //! whether system is initialized
-                if (TER_READY_BUSY == s_tCurrentStatus) {
-                    EXIT_SAFE_ATOM_CODE();
-                    return fsm_rt_on_going;
-                }
-                //! set current state
-                s_tCurrentStatus = TER_READY_BUSY;
-            )
-            s_chSend[2] = 'u';
-            s_tState = TERMINAL_RESUME_SEND;
-            break;
-
-        case TERMINAL_RESUME_SEND:
-            if (fsm_rt_cpl == fsm_ter_stream_exchange(s_chSend, 3)) {
-                SAFE_ATOM_CODE(
-                    //! set idle state
-                    s_tCurrentStatus = TER_READY_IDLE;
-                )
-                TERMINAL_RESUME_RESET();
-                return fsm_rt_cpl;
-            }
-            break;
-    }
-    
-    return fsm_rt_on_going;
+    static coroutine_t s_tTask = 0;
+    NO_INIT static uint8_t *s_pchCode;
+
+    TASK_BEGIN(s_tTask)
+        AWAIT(ter_lock());
+        //! wait for the output
+        AWAIT(NULL != (s_pchCode = ter_code_buffer(3)));
+
+        s_pchCode[0] = ASCII_ESC;
+        s_pchCode[1] = '[';
+        s_pchCode[2] = 'u';
+        AWAIT_FSM(ter_code_send(s_pchCode, 3));
+
+        s_tCursor = s_tSavedCursor;
+        s_tDeviceCursor = s_tSavedDeviceCursor;
+        s_bDeviceCursorValid = s_bSavedDeviceCursorValid;
+    TASK_END(
+        ter_unlock();
+    )
+}
+
+/*! \brief set display attribute
+ *! \param tBrush display attribute
+ *! \retval fsm_rt_on_going set brush on going
+ *! \retval fsm_rt_cpl set brush finish
+ */
+static fsm_rt_t ter_set_brush(grid_brush_t tBrush)
+{
+    static coroutine_t s_tTask = 0;
+    NO_INIT static uint8_t *s_pchCode;
+
+    TASK_BEGIN(s_tTask)
+        if ( ( tBrush.tForeground.tValue > 7 ) || ( tBrush.tBackground.tValue > 7 ) ) {
+            TASK_RETURN(fsm_rt_err);
+        }
+        AWAIT(ter_lock());
+        //! wait for the output
+        AWAIT(NULL != (s_pchCode = ter_code_buffer(8)));
+
+        SAFE_ATOM_CODE(
+            s_tCurrentGridBrush = tBrush;
+            s_bBrushValid = true;
+        )
+        ter_build_brush_code(s_pchCode, tBrush);
+        AWAIT_FSM(ter_code_send(s_pchCode, 8));
+    TASK_END(
+        ter_unlock();
+    )
 }
 
-#define TERMINAL_SET_BRUSH_RESET()	            \
-    do {                                        \
-        s_tState = TERMINAL_SET_BRUSH_START;    \
-    }	while(0)    
 /*! \brief set display attribute
  *! \param tBrush display attribute
  *! \retval fsm_rt_on_going set brush on going
@@ -530,49 +825,8 @@ static fsm_rt_t terminal_resume(void)
  */
 static fsm_rt_t terminal_set_brush(grid_brush_t tBrush)
 {
-	static enum {
-		TERMINAL_SET_BRUSH_START = 0,
-		TERMINAL_SET_BRUSH_SEND
-	} s_tState = TERMINAL_SET_BRUSH_START;
-
-	switch ( s_tState ) {
-		case TERMINAL_SET_BRUSH_START:
-			if ( ( tBrush.tForeground.tValue > 7 ) || ( tBrush.tBackground.tValue > 7 ) ) {
-				return fsm_rt_err;
-			}
-            SAFE_ATOM_CODE(
-                //! whether system is initialized
-                if (TER_READY_BUSY == s_tCurrentStatus) {
-                    EXIT_SAFE_ATOM_CODE();
-                    return fsm_rt_on_going;
-                }
-                //! set current state
-                s_tCurrentStatus = TER_READY_BUSY;
-
-                s_tCurrentGridBrush = tBrush;
-            )
-			s_chSend[2] = '3';
-			s_chSend[3] = tBrush.tForeground.tValue + '0';
-			s_chSend[4] = ';';
-			s_chSend[5] = '4';
-			s_chSend[6] = tBrush.tBackground.tValue + '0';
-			s_chSend[7] = 'm';
-            s_tState = TERMINAL_SET_BRUSH_SEND;
-			//break;
-
-		case TERMINAL_SET_BRUSH_SEND:
-			if (fsm_rt_cpl == fsm_ter_stream_exchange(s_chSend, 8)) {
-                SAFE_ATOM_CODE(
-                    //! set idle state
-                    s_tCurrentStatus = TER_READY_IDLE;
-                )
-				TERMINAL_SET_BRUSH_RESET();
-				return fsm_rt_cpl;
-			}
-			break;
-	}
-
-	return fsm_rt_on_going;
+    TGUI_TRACE_RESUME(TGUI_TRACE_SET_BRUSH);
+    return TGUI_TRACE_PAUSE(TGUI_TRACE_SET_BRUSH, ter_set_brush(tBrush));
 }
 
 /*! \brief get display attribute
@@ -597,78 +851,382 @@ static grid_brush_t terminal_get_brush(void)
  */
 static fsm_rt_t terminal_clear(void)
 {
-	static enum {
-		TERMINAL_START = 0,
-		TERMINAL_CLEAR
-	} s_tState = TERMINAL_START;
-
-    switch (s_tState) {
-		case TERMINAL_START:
-            SAFE_ATOM_CODE(
-                //! whether system is initialized
-                if (TER_READY_BUSY == s_tCurrentStatus) {
-                    EXIT_SAFE_ATOM_CODE();
-                    return fsm_rt_on_going;
-                }
-                //! set current state
-                s_tCurrentStatus = TER_READY_BUSY;
-            )
-            s_tState = TERMINAL_CLEAR;
-            //break;
-
-        case TERMINAL_CLEAR:
-            if ( TGUI_TERMINAL_WRITE_BYTE(TGUI_TERMINAL_CLEAR_CODE) ) {
-                SAFE_ATOM_CODE(
-                    //! set idle state
-                    s_tCurrentStatus = TER_READY_IDLE;
-                )
-                return fsm_rt_cpl;
+    static coroutine_t s_tTask = 0;
+    static const uint8_t c_chCode = TGUI_TERMINAL_CLEAR_CODE;
+
+    TASK_BEGIN(s_tTask)
+        AWAIT(ter_lock());
+        AWAIT(0 != ter_write(&c_chCode, 1));
+        //! clearing moves both the cursor and the device cursor to home
+        do {
+            const grid_t tHome = HOME;
+            s_tCursor = tHome;
+            s_tDeviceCursor = tHome;
+            s_bDeviceCursorValid = true;
+        } while (false);
+    TASK_END(
+        ter_unlock();
+    )
+}
+
+/*! \brief terminal print, the string is cut by current viewport
+ *! \param pchString string buffer
+ *! \param hwSize string length
+ *! \retval fsm_rt_on_going terminal print on going
+ *! \retval fsm_rt_cpl terminal print finish
+ */
+static fsm_rt_t ter_print(uint8_t *pchString, uint_fast16_t hwSize)
+{
+    static coroutine_t s_tTask = 0;
+    NO_INIT static uint8_t *s_pchSpan;
+    NO_INIT static uint8_t s_chSpanSize;
+    NO_INIT static uint8_t s_chMoveSize;
+    NO_INIT static uint8_t *s_pchCode;
+    NO_INIT static grid_t s_tStart;
+
+    TASK_BEGIN(s_tTask)
+        if ((NULL == pchString) || (0 == hwSize)) {
+            TASK_RETURN(fsm_rt_cpl);
+        }
+        //! the viewport and the cursor only change with the terminal locked
+        AWAIT(ter_lock());
+
+        do {
+            uint_fast16_t hwOffset;
+
+            //! cut the string by the viewport before any output is reserved
+            s_chSpanSize = ter_clip_span(hwSize, &s_tStart, &hwOffset);
+            if (0 == s_chSpanSize) {
+                //! fully clipped, nothing to send
+                TASK_EXIT(fsm_rt_cpl);
             }
-            break;
-    }
+            s_pchSpan = pchString + hwOffset;
+        } while (false);
+
+        //! wait for the output
+        AWAIT(NULL != (s_pchCode = ter_code_buffer(8)));
 
-	return fsm_rt_on_going;
+        //! move the device cursor to the beginning of the visible part
+        s_chMoveSize = ter_build_move_code(s_pchCode, s_tStart);
+        ter_advance_device_cursor(s_chSpanSize);
+
+        AWAIT_FSM(ter_code_send(s_pchCode, s_chMoveSize));
+        AWAIT_FSM(fsm_ter_stream_exchange(s_pchSpan, s_chSpanSize));
+    TASK_END(
+        ter_unlock();
+    )
 }
 
-/*! \brief terminal print
- *! \param none
+/*! \brief terminal print, the string is cut by current viewport
+ *! \param pchString string buffer
+ *! \param hwSize string length
  *! \retval fsm_rt_on_going terminal print on going
  *! \retval fsm_rt_cpl terminal print finish
  */
 static fsm_rt_t terminal_print(uint8_t *pchString, uint_fast16_t hwSize)
 {
-	static enum {
-		TERMINAL_START = 0,
-		TERMINAL_PRINT,
-	} s_tState = TERMINAL_START;
-
-    switch (s_tState) {
-		case TERMINAL_START:
-            SAFE_ATOM_CODE(
-                //! whether system is initialized
-                if (TER_READY_BUSY == s_tCurrentStatus) {
-                    EXIT_SAFE_ATOM_CODE();
-                    return fsm_rt_on_going;
+    TGUI_TRACE_RESUME(TGUI_TRACE_PRINT);
+    return TGUI_TRACE_PAUSE(TGUI_TRACE_PRINT, ter_print(pchString, hwSize));
+}
+
+/*! \brief move the content of full-width rows with scroll region and
+ *!        insert / delete line
+ *! \param tRegion rows to scroll, it should be as wide as the screen
+ *! \param chOffset content movement along y, rows exposed are blank
+ *! \retval fsm_rt_on_going terminal scroll on going
+ *! \retval fsm_rt_cpl terminal scroll finish
+ *! \retval fsm_rt_err the region is not scrollable
+ */
+static fsm_rt_t terminal_scroll(grid_rect_t tRegion, int_fast8_t chOffset)
+{
+    static coroutine_t s_tTask = 0;
+    //! ESC[t;br ESC[t;1H ESC[nM ESC[r
+    NO_INIT static uint8_t *s_pchCode;
+    NO_INIT static uint8_t s_chSize;
+    NO_INIT static uint8_t s_chTop;
+    NO_INIT static uint8_t s_chBottom;
+
+    TASK_BEGIN(s_tTask)
+        //! the viewport only changes with the terminal unlocked
+        AWAIT(ter_lock());
+
+        do {
+            grid_rect_t tClip;
+
+            //! translate to the screen
+            tRegion.chLeft += s_ptViewport->tOrigin.chX;
+            tRegion.chTop += s_ptViewport->tOrigin.chY;
+            if (    !grid_rect_intersect(s_ptViewport->tClip, tRegion, &tClip)
+                ||  (0 != tClip.chLeft) || (WIDTH != tClip.chWidth)
+                ||  (tClip.chTop != tRegion.chTop)
+                ||  (tClip.chHeight != tRegion.chHeight)) {
+                TASK_EXIT(fsm_rt_err);
+            } else if (0 == chOffset) {
+                TASK_EXIT(fsm_rt_cpl);
+            } else if (ABS(chOffset) >= tRegion.chHeight) {
+                TASK_EXIT(fsm_rt_err);
+            }
+
+            //! the row number grows when y decreases
+            s_chTop = HEIGHT - (tRegion.chTop + tRegion.chHeight - 1);
+            s_chBottom = HEIGHT - tRegion.chTop;
+        } while (false);
+
+        //! wait for the output
+        AWAIT(NULL != (s_pchCode = ter_code_buffer(24)));
+
+        do {
+            uint8_t chIndex = 0;
+
+            s_pchCode[chIndex++] = ASCII_ESC;
+            s_pchCode[chIndex++] = '[';
+            chIndex += ter_format_number(&s_pchCode[chIndex], s_chTop);
+            s_pchCode[chIndex++] = ';';
+            chIndex += ter_format_number(&s_pchCode[chIndex], s_chBottom);
+            s_pchCode[chIndex++] = 'r';
+
+            s_pchCode[chIndex++] = ASCII_ESC;
+            s_pchCode[chIndex++] = '[';
+            chIndex += ter_format_number(&s_pchCode[chIndex], s_chTop);
+            s_pchCode[chIndex++] = ';';
+            s_pchCode[chIndex++] = '1';
+            s_pchCode[chIndex++] = 'H';
+
+            //! moving up on the screen is deleting lines at the top
+            s_pchCode[chIndex++] = ASCII_ESC;
+            s_pchCode[chIndex++] = '[';
+            chIndex += ter_format_number(&s_pchCode[chIndex], ABS(chOffset));
+            s_pchCode[chIndex++] = (chOffset > 0) ? 'M' : 'L';
+
+            s_pchCode[chIndex++] = ASCII_ESC;
+            s_pchCode[chIndex++] = '[';
+            s_pchCode[chIndex++] = 'r';
+            s_chSize = chIndex;
+        } while (false);
+
+        //! resetting scroll region moves the cursor to home
+        s_bDeviceCursorValid = false;
+        AWAIT_FSM(ter_code_send(s_pchCode, s_chSize));
+    TASK_END(
+        ter_unlock();
+    )
+}
+
+/*! \brief check a batch of draw commands
+ *! \param ptCommands command array
+ *! \param hwCount number of commands
+ *! \retval true all commands are valid
+ *! \retval false invalid command found
+ */
+static bool ter_check_draw(const grid_draw_t *ptCommands, uint_fast16_t hwCount)
+{
+    for (; hwCount--; ptCommands++) {
+        switch (ptCommands->chCommand) {
+            case GRID_DRAW_MOVE:
+            case GRID_DRAW_FILL:
+                break;
+            case GRID_DRAW_BRUSH:
+                if (    (ptCommands->tBrush.tForeground.tValue > 7)
+                    ||  (ptCommands->tBrush.tBackground.tValue > 7)) {
+                    return false;
                 }
-                //! set current state
-                s_tCurrentStatus = TER_READY_BUSY;
-            )
-            s_tState = TERMINAL_PRINT;
-            //break;
-
-        case TERMINAL_PRINT:
-            if (fsm_rt_cpl == fsm_ter_stream_exchange(pchString, hwSize)) {
-                SAFE_ATOM_CODE(
-                    //! set idle state
-                    s_tCurrentStatus = TER_READY_IDLE;
-                )
-                return fsm_rt_cpl;
+                break;
+            case GRID_DRAW_TEXT:
+                if ((NULL == ptCommands->Text.pchString) && (0 != ptCommands->Text.hwSize)) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/*! \brief execute a batch of draw commands with the terminal locked once,
+ *!        cursor movements are only sent when something visible follows
+ *!        them and a display attribute is sent before the next visible
+ *!        output, or at the end of the batch so later prints use it
+ *! \param ptCommands command array
+ *! \param hwCount number of commands
+ *! \retval fsm_rt_on_going terminal draw on going
+ *! \retval fsm_rt_cpl terminal draw finish
+ *! \retval fsm_rt_err invalid command, nothing is drawn
+ */
+static fsm_rt_t terminal_draw(const grid_draw_t *ptCommands, uint_fast16_t hwCount)
+{
+    static coroutine_t s_tTask = 0;
+    NO_INIT static const grid_draw_t *s_ptCommand;
+    NO_INIT static uint_fast16_t s_hwCount;
+    NO_INIT static grid_brush_t s_tBrush;
+    NO_INIT static bool s_bBrushPending;
+    //! ESC[3f;4bm ESC[row;colH
+    NO_INIT static uint8_t *s_pchCode;
+    NO_INIT static uint8_t s_chCodeSize;
+    NO_INIT static const uint8_t *s_pchSpan;
+    NO_INIT static uint8_t s_chSpanSize;
+    NO_INIT static uint8_t s_chFillChar;
+    NO_INIT static grid_rect_t s_tFill;
+
+    TASK_BEGIN(s_tTask)
+        if ((NULL == ptCommands) || (0 == hwCount)) {
+            TASK_RETURN(fsm_rt_cpl);
+        } else if (!ter_check_draw(ptCommands, hwCount)) {
+            TASK_RETURN(fsm_rt_err);
+        }
+        s_ptCommand = ptCommands;
+        s_hwCount = hwCount;
+        s_bBrushPending = false;
+        AWAIT(ter_lock());
+
+        while (true) {
+            //! wait for the output
+            AWAIT(NULL != (s_pchCode = ter_code_buffer(16)));
+
+            do {
+                grid_t tStart;
+
+                s_chCodeSize = 0;
+                s_pchSpan = NULL;
+                s_chSpanSize = 0;
+                s_tFill.chHeight = 0;
+
+                //! commands without output are done here without returning
+                while (0 != s_hwCount) {
+                    const grid_draw_t *ptCommand = s_ptCommand++;
+                    s_hwCount--;
+
+                    if (GRID_DRAW_MOVE == ptCommand->chCommand) {
+                        s_tCursor.chX = ptCommand->tGrid.chX + s_ptViewport->tOrigin.chX;
+                        s_tCursor.chY = ptCommand->tGrid.chY + s_ptViewport->tOrigin.chY;
+                    } else if (GRID_DRAW_BRUSH == ptCommand->chCommand) {
+                        s_tBrush = ptCommand->tBrush;
+                        s_bBrushPending = true;
+                    } else if (GRID_DRAW_TEXT == ptCommand->chCommand) {
+                        uint_fast16_t hwOffset;
+                        s_chSpanSize = ter_clip_span(ptCommand->Text.hwSize, &tStart, &hwOffset);
+                        if (0 != s_chSpanSize) {
+                            s_pchSpan = ptCommand->Text.pchString + hwOffset;
+                            break;
+                        }
+                    } else {
+                        grid_rect_t tRect = ptCommand->Fill.tRect;
+                        tRect.chLeft += s_ptViewport->tOrigin.chX;
+                        tRect.chTop += s_ptViewport->tOrigin.chY;
+                        if (grid_rect_intersect(s_ptViewport->tClip, tRect, &s_tFill)) {
+                            s_chFillChar = ptCommand->Fill.chChar;
+                            s_chSpanSize = s_tFill.chWidth;
+                            tStart = s_tFill.__grid_t;
+                            break;
+                        }
+                    }
+                }
+
+                //! the display attribute is sent before the first visible output
+                if (    s_bBrushPending
+                    &&  (   !s_bBrushValid
+                        ||  (s_tBrush.tForeground.tValue != s_tCurrentGridBrush.tForeground.tValue)
+                        ||  (s_tBrush.tBackground.tValue != s_tCurrentGridBrush.tBackground.tValue))) {
+                    s_chCodeSize = ter_build_brush_code(s_pchCode, s_tBrush);
+                    //! the same as ter_set_brush(), Get() may read it from ISRs
+                    SAFE_ATOM_CODE(
+                        s_tCurrentGridBrush = s_tBrush;
+                        s_bBrushValid = true;
+                    )
+                }
+                s_bBrushPending = false;
+
+                if (0 != s_chSpanSize) {
+                    s_chCodeSize += ter_build_move_code(&s_pchCode[s_chCodeSize], tStart);
+                } else if (0 == s_chCodeSize) {
+                    //! all commands are done
+                    TASK_EXIT(fsm_rt_cpl);
+                }
+            } while (false);
+
+            AWAIT_FSM(ter_code_send(s_pchCode, s_chCodeSize));
+
+            if (NULL != s_pchSpan) {
+                AWAIT_FSM(fsm_ter_stream_exchange((uint8_t *)s_pchSpan, s_chSpanSize));
+                ter_advance_device_cursor(s_chSpanSize);
+                continue;
+            }
+
+            //! fill rows one by one
+            while (true) {
+                while (0 != s_chSpanSize) {
+                    uint8_t chCount;
+                    //! only wait when the output is full
+                    AWAIT(0 != (chCount = ter_fill(s_chFillChar, s_chSpanSize)));
+                    s_chSpanSize -= chCount;
+                    ter_advance_device_cursor(chCount);
+                }
+                if (s_tFill.chHeight <= 1) {
+                    break;
+                }
+
+                //! next row of the fill
+                AWAIT(NULL != (s_pchCode = ter_code_buffer(8)));
+                s_tFill.chTop++;
+                s_tFill.chHeight--;
+                s_chSpanSize = s_tFill.chWidth;
+                s_chCodeSize = ter_build_move_code(s_pchCode, s_tFill.__grid_t);
+                AWAIT_FSM(ter_code_send(s_pchCode, s_chCodeSize));
             }
-            break;
+        }
+    TASK_END(
+        ter_unlock();
+    )
+}
+
+/*! \brief enter a viewport inside the current one, following drawing operations
+ *!        are relative to the viewport and clipped by it
+ *! \param tViewport viewport position and size inside the current viewport
+ *! \retval true viewport is entered
+ *! \retval false too many nested viewports or an operation is on going
+ */
+static bool terminal_push_viewport(grid_rect_t tViewport)
+{
+    ter_viewport_t *ptViewport = s_ptViewport + 1;
+
+    //! operations on going use the viewport across polls
+    if (!ter_lock()) {
+        return false;
+    } else if (ptViewport >= &s_tViewportStack[UBOUND(s_tViewportStack)]) {
+        ter_unlock();
+        return false;
     }
 
-	return fsm_rt_on_going;
+    tViewport.chLeft += s_ptViewport->tOrigin.chX;
+    tViewport.chTop += s_ptViewport->tOrigin.chY;
+    ptViewport->tOrigin = tViewport.__grid_t;
+    //! an empty clip rectangle rejects all drawing
+    grid_rect_intersect(s_ptViewport->tClip, tViewport, &(ptViewport->tClip));
+    s_ptViewport = ptViewport;
+    ter_unlock();
+
+    return true;
+}
+
+/*! \brief leave current viewport
+ *! \param none
+ *! \retval true viewport is left
+ *! \retval false no viewport to leave or an operation is on going
+ */
+static bool terminal_pop_viewport(void)
+{
+    //! operations on going use the viewport across polls
+    if (!ter_lock()) {
+        return false;
+    } else if (s_ptViewport == s_tViewportStack) {
+        ter_unlock();
+        return false;
+    }
+    s_ptViewport--;
+    ter_unlock();
 
+    return true;
 }
 
 #endif  /* USE_SERVICE_GUI_TGUI == ENABLED */
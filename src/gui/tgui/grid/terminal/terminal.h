@@ -19,6 +19,24 @@
 //! terminal interface
 extern const i_gdc_t terminal;
 
+#ifdef TGUI_TERMINAL_TX_BUFFER_SIZE
+/*! \brief transmit complete handler, register it to the transmit complete
+ *!        delegate of the driver
+ *! \param pArg not used
+ *! \param pParam not used
+ *! \return fsm_rt_cpl
+ */
+extern fsm_rt_t terminal_tx_cpl(void *pArg, void *pParam);
+
+/*! \brief retry the output the driver refused, e.g. the tail of the last
+ *!        operation. It could be the routine of a scheduler task.
+ *! \param pArg not used
+ *! \retval fsm_rt_on_going some output is not handed to the driver yet
+ *! \retval fsm_rt_cpl all output is handed to the driver
+ */
+extern fsm_rt_t terminal_tx_poll(void *pArg);
+#endif
+
 #endif  /* USE_SERVICE_GUI_TGUI == ENABLED */
 
 #endif  /* __TERMINAL_H__ */
@@ -0,0 +1,72 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+//! \note do not move this pre-processor statement to other places
+#include "..\app_cfg.h"
+
+#ifndef __TGUI_TRACE_APP_CFG_H__
+#define __TGUI_TRACE_APP_CFG_H__
+
+/*============================ INCLUDES ======================================*/
+/*============================ MACROS ========================================*/
+//! \brief measure the hot paths of tgui, it compiles to nothing when disabled
+#ifndef USE_TGUI_TRACE
+#   define USE_TGUI_TRACE               DISABLED
+#endif
+
+//! \brief number of (id, cycles) records kept, a power of two
+#ifndef TGUI_TRACE_RECORD_COUNT
+#   define TGUI_TRACE_RECORD_COUNT      (64)
+#endif
+
+//! \brief number of trace IDs, the built-in ones included
+#ifndef TGUI_TRACE_ID_COUNT
+#   define TGUI_TRACE_ID_COUNT          (8)
+#endif
+
+//! \brief free running 32bit counter the spans are measured with, a port 
+//!        could define its own with TGUI_TRACE_START_TICK() to start it
+#ifndef TGUI_TRACE_GET_TICK
+#   if defined(__CPU_HOST__)
+//! monotonic clock of the host, in nano seconds
+#       define TGUI_TRACE_GET_TICK()        host_get_tick()
+#   elif __CPU_HAS_CYCLE_COUNTER__
+//! DWT CYCCNT
+#       define TGUI_TRACE_GET_TICK()        (*(volatile uint32_t *)0xE0001004)
+#       define TGUI_TRACE_START_TICK()                                      \
+            do {                                                            \
+                (*(volatile uint32_t *)0xE000EDFC) |= _BV(24);              \
+                (*(volatile uint32_t *)0xE0001000) |= _BV(0);               \
+            } while(false)
+#   endif
+#endif
+
+#ifndef TGUI_TRACE_START_TICK
+#   define TGUI_TRACE_START_TICK()
+#endif
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+#endif  /* __TGUI_TRACE_APP_CFG_H__ */
+
+/* EOF */
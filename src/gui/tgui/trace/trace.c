@@ -0,0 +1,255 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*============================ INCLUDES ======================================*/
+#include ".\app_cfg.h"
+
+#if USE_TGUI_TRACE == ENABLED
+#include ".\trace.h"
+
+/*============================ MACROS ========================================*/
+#ifndef TGUI_TRACE_GET_TICK
+#   error No defined TGUI_TRACE_GET_TICK
+#endif
+
+#if (TGUI_TRACE_RECORD_COUNT & (TGUI_TRACE_RECORD_COUNT - 1)) != 0
+#   error TGUI_TRACE_RECORD_COUNT should be a power of two
+#endif
+
+#if TGUI_TRACE_ID_COUNT > 255
+#   error TGUI_TRACE_ID_COUNT should be 255 at most
+#endif
+
+#define TGUI_TRACE_MASK                 (TGUI_TRACE_RECORD_COUNT - 1)
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+
+//! \name spans of a trace ID
+//! @{
+typedef struct {
+    volatile uint32_t       wStart;         //!< tick the current span began
+    uint32_t                wPolled;        //!< polls added up so far
+    uint32_t                wCount;         //!< number of spans
+    uint32_t                wMin;           //!< the shortest span
+    uint32_t                wMax;           //!< the longest span
+    uint64_t                dwTotal;        //!< sum of the spans
+} tgui_trace_id_t;
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+static tgui_trace_id_t s_tID[TGUI_TRACE_ID_COUNT];
+
+//! \note the oldest record is overwritten when the ring is full
+static tgui_trace_record_t s_tRecord[TGUI_TRACE_RECORD_COUNT];
+static uint32_t s_wRecorded = 0;
+
+/*============================ PROTOTYPES ====================================*/
+/*============================ IMPLEMENTATION ================================*/
+
+/*! \brief clear the records and start the counter, e.g. the DWT cycle counter
+ *! \param none
+ *! \return none
+ */
+void tgui_trace_init(void)
+{
+    TGUI_TRACE_START_TICK();
+    tgui_trace_reset();
+}
+
+/*! \brief begin a span, it is called by TGUI_TRACE_BEGIN()
+ *! \param chID trace ID
+ *! \return none
+ */
+void tgui_trace_begin(uint_fast8_t chID)
+{
+    if (chID < TGUI_TRACE_ID_COUNT) {
+        //! read the counter as late as possible
+        s_tID[chID].wStart = TGUI_TRACE_GET_TICK();
+    }
+}
+
+/*! \brief record a span
+ *! \param ptID the trace ID
+ *! \param chID trace ID
+ *! \param wCycles length of the span
+ *! \return none
+ */
+static void tgui_trace_record(
+    tgui_trace_id_t *ptID, uint_fast8_t chID, uint32_t wCycles)
+{
+    tgui_trace_record_t *ptRecord;
+
+    SAFE_ATOM_CODE(
+        if ((0 == ptID->wCount) || (wCycles < ptID->wMin)) {
+            ptID->wMin = wCycles;
+        }
+        if (wCycles > ptID->wMax) {
+            ptID->wMax = wCycles;
+        }
+        ptID->wCount++;
+        ptID->dwTotal += wCycles;
+
+        ptRecord = &s_tRecord[s_wRecorded & TGUI_TRACE_MASK];
+        ptRecord->chID = chID;
+        ptRecord->wCycles = wCycles;
+        s_wRecorded++;
+    )
+}
+
+/*! \brief end a span and record it, it is called by TGUI_TRACE_END()
+ *! \param chID trace ID
+ *! \return none
+ */
+void tgui_trace_end(uint_fast8_t chID)
+{
+    //! read the counter as early as possible
+    uint32_t wNow = TGUI_TRACE_GET_TICK();
+
+    if (chID >= TGUI_TRACE_ID_COUNT) {
+        return ;
+    }
+    tgui_trace_record(&s_tID[chID], chID, wNow - s_tID[chID].wStart);
+}
+
+/*! \brief end a poll of a state machine, it is called by TGUI_TRACE_PAUSE()
+ *! \param chID trace ID
+ *! \param tFSM the result of the poll, the polls are recorded as one span
+ *!        when it is not fsm_rt_on_going
+ *! \return tFSM
+ */
+fsm_rt_t tgui_trace_pause(uint_fast8_t chID, fsm_rt_t tFSM)
+{
+    uint32_t wNow = TGUI_TRACE_GET_TICK();
+    tgui_trace_id_t *ptID;
+
+    if (chID >= TGUI_TRACE_ID_COUNT) {
+        return tFSM;
+    }
+    ptID = &s_tID[chID];
+    ptID->wPolled += wNow - ptID->wStart;
+    if (fsm_rt_on_going != tFSM) {
+        tgui_trace_record(ptID, chID, ptID->wPolled);
+        ptID->wPolled = 0;
+    }
+
+    return tFSM;
+}
+
+/*! \brief copy the latest records, the oldest first. The interrupts are
+ *!        masked for one record at a time, so the copy stops early when the
+ *!        records not copied yet are overwritten
+ *! \param ptRecord buffer of the records
+ *! \param hwCount size of the buffer in records
+ *! \return the number of records copied
+ */
+uint_fast16_t tgui_trace_read(
+    tgui_trace_record_t *ptRecord, uint_fast16_t hwCount)
+{
+    uint32_t wIndex;
+    uint_fast16_t n;
+
+    if (NULL == ptRecord) {
+        return 0;
+    }
+
+    SAFE_ATOM_CODE(
+        wIndex = s_wRecorded;
+    )
+    if (hwCount > TGUI_TRACE_RECORD_COUNT) {
+        hwCount = TGUI_TRACE_RECORD_COUNT;
+    }
+    if (hwCount > wIndex) {
+        hwCount = wIndex;
+    }
+    wIndex -= hwCount;
+
+    for (n = 0; n < hwCount; n++, wIndex++) {
+        bool bValid = false;
+
+        SAFE_ATOM_CODE(
+            //! the hot paths keep recording in between
+            if ((s_wRecorded - wIndex) <= TGUI_TRACE_RECORD_COUNT) {
+                ptRecord[n] = s_tRecord[wIndex & TGUI_TRACE_MASK];
+                bValid = true;
+            }
+        )
+        if (!bValid) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+/*! \brief get the min / average / max of an ID
+ *! \param chID trace ID
+ *! \param ptStat statistics of the ID
+ *! \retval true the statistics is got
+ *! \retval false invalid parameter or the ID is not recorded yet
+ */
+bool tgui_trace_get_stat(uint_fast8_t chID, tgui_trace_stat_t *ptStat)
+{
+    tgui_trace_id_t tID;
+
+    if ((chID >= TGUI_TRACE_ID_COUNT) || (NULL == ptStat)) {
+        return false;
+    }
+
+    SAFE_ATOM_CODE(
+        tID = s_tID[chID];
+    )
+    if (0 == tID.wCount) {
+        return false;
+    }
+
+    ptStat->wCount = tID.wCount;
+    ptStat->wMin = tID.wMin;
+    ptStat->wAverage = (uint32_t)(tID.dwTotal / tID.wCount);
+    ptStat->wMax = tID.wMax;
+
+    return true;
+}
+
+/*! \brief clear the records and the statistics
+ *! \param none
+ *! \return none
+ */
+void tgui_trace_reset(void)
+{
+    uint_fast8_t n;
+
+    for (n = 0; n < TGUI_TRACE_ID_COUNT; n++) {
+        SAFE_ATOM_CODE(
+            s_tID[n].wPolled = 0;
+            s_tID[n].wCount = 0;
+            s_tID[n].wMin = 0;
+            s_tID[n].wMax = 0;
+            s_tID[n].dwTotal = 0;
+        )
+    }
+    SAFE_ATOM_CODE(
+        s_wRecorded = 0;
+    )
+}
+
+#endif  /* USE_TGUI_TRACE == ENABLED */
+
+/* EOF */
@@ -0,0 +1,148 @@
+/***************************************************************************
+ *   Copyright(C)2009-2014 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __TGUI_TRACE_H__
+#define __TGUI_TRACE_H__
+
+/*============================ INCLUDES ======================================*/
+#include ".\app_cfg.h"
+
+/*============================ MACROS ========================================*/
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*! \brief mark the beginning and the end of a span to measure, the span of an
+ *!        ID should not nest or overlap with itself. The END could be in
+ *!        another function or an ISR, e.g. the completion of a transmission.
+ *!
+ *!        static fsm_rt_t flush(void)
+ *!        {
+ *!            TGUI_TRACE_BEGIN(TGUI_TRACE_FLUSH);
+ *!            ...
+ *!            TGUI_TRACE_END(TGUI_TRACE_FLUSH);
+ *!        }
+ */
+/*! \brief measure a state machine polled several times, the polls between
+ *!        RESUME and PAUSE are added up and recorded as one span when the
+ *!        state machine returns anything but fsm_rt_on_going
+ *!
+ *!        static fsm_rt_t print(uint8_t *pchString, uint_fast16_t hwSize)
+ *!        {
+ *!            TGUI_TRACE_RESUME(TGUI_TRACE_PRINT);
+ *!            return TGUI_TRACE_PAUSE(TGUI_TRACE_PRINT, fsm_print(...));
+ *!        }
+ */
+#if USE_TGUI_TRACE == ENABLED
+#define TGUI_TRACE_BEGIN(__ID)          tgui_trace_begin(__ID)
+#define TGUI_TRACE_END(__ID)            tgui_trace_end(__ID)
+#define TGUI_TRACE_RESUME(__ID)         tgui_trace_begin(__ID)
+#define TGUI_TRACE_PAUSE(__ID, __FSM)   tgui_trace_pause((__ID), (__FSM))
+#else
+#define TGUI_TRACE_BEGIN(__ID)
+#define TGUI_TRACE_END(__ID)
+#define TGUI_TRACE_RESUME(__ID)
+#define TGUI_TRACE_PAUSE(__ID, __FSM)   (__FSM)
+#endif
+
+/*============================ TYPES =========================================*/
+//! \name trace ID
+//! @{
+typedef enum {
+    TGUI_TRACE_SET_GRID     = 0,    //!< set the cursor position
+    TGUI_TRACE_SET_BRUSH,           //!< set the display attribute
+    TGUI_TRACE_PRINT,               //!< print a string
+    TGUI_TRACE_FLUSH,               //!< send the buffered output
+    TGUI_TRACE_USER,                //!< the first ID of the application
+} em_tgui_trace_id_t;
+//! @}
+
+//! \name trace record
+//! @{
+typedef struct {
+    uint8_t         chID;           //!< em_tgui_trace_id_t
+    uint32_t        wCycles;        //!< length of the span, nano seconds on host
+} tgui_trace_record_t;
+//! @}
+
+//! \name statistics of a trace ID
+//! @{
+typedef struct {
+    uint32_t        wCount;         //!< number of spans
+    uint32_t        wMin;           //!< the shortest span
+    uint32_t        wAverage;       //!< average of the spans
+    uint32_t        wMax;           //!< the longest span
+} tgui_trace_stat_t;
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+#if USE_TGUI_TRACE == ENABLED
+/*! \brief clear the records and start the counter, e.g. the DWT cycle counter
+ *! \param none
+ *! \return none
+ */
+extern void tgui_trace_init(void);
+
+/*! \brief begin a span, it is called by TGUI_TRACE_BEGIN()
+ *! \param chID trace ID
+ *! \return none
+ */
+extern void tgui_trace_begin(uint_fast8_t chID);
+
+/*! \brief end a span and record it, it is called by TGUI_TRACE_END()
+ *! \param chID trace ID
+ *! \return none
+ */
+extern void tgui_trace_end(uint_fast8_t chID);
+
+/*! \brief end a poll of a state machine, it is called by TGUI_TRACE_PAUSE()
+ *! \param chID trace ID
+ *! \param tFSM the result of the poll, the polls are recorded as one span
+ *!        when it is not fsm_rt_on_going
+ *! \return tFSM
+ */
+extern fsm_rt_t tgui_trace_pause(uint_fast8_t chID, fsm_rt_t tFSM);
+
+/*! \brief copy the latest records, the oldest first. The interrupts are
+ *!        masked for one record at a time, so the copy stops early when the
+ *!        records not copied yet are overwritten
+ *! \param ptRecord buffer of the records
+ *! \param hwCount size of the buffer in records
+ *! \return the number of records copied
+ */
+extern uint_fast16_t tgui_trace_read(
+    tgui_trace_record_t *ptRecord, uint_fast16_t hwCount);
+
+/*! \brief get the min / average / max of an ID
+ *! \param chID trace ID
+ *! \param ptStat statistics of the ID
+ *! \retval true the statistics is got
+ *! \retval false invalid parameter or the ID is not recorded yet
+ */
+extern bool tgui_trace_get_stat(uint_fast8_t chID, tgui_trace_stat_t *ptStat);
+
+/*! \brief clear the records and the statistics
+ *! \param none
+ *! \return none
+ */
+extern void tgui_trace_reset(void);
+#endif
+
+#endif
+/* EOF */
@@ -98,6 +98,17 @@
     #define NOP()                       __asm__ __volatile__ ("nop");
 #endif
 
+//! \brief memory accesses before it complete before the ones after it
+#ifndef MEMORY_BARRIER
+#if __IS_COMPILER_IAR__
+    #define MEMORY_BARRIER()            __DMB()
+#elif __IS_COMPILER_MDK__
+    #define MEMORY_BARRIER()            __dmb(0xF)
+#else
+    #define MEMORY_BARRIER()            __asm__ __volatile__ ("dmb" ::: "memory")
+#endif
+#endif
+
 
 //! \brief none standard memory types
 #if __IS_COMPILER_IAR__
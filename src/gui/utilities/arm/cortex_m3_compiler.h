@@ -40,6 +40,12 @@
 /*ARM Cortex M4 implementation for interrupt priority shift*/
 # define ARM_INTERRUPT_LEVEL_BITS       4
 
+//! \brief the core has LDREX / STREX
+# define __CPU_HAS_EXCLUSIVE_ACCESS__   true
+
+//! \brief the core has the DWT cycle counter
+# define __CPU_HAS_CYCLE_COUNTER__      true
+
 
 #endif
 
@@ -26,13 +26,63 @@
 #include "..\compiler.h"
 
 /*============================ MACROS ========================================*/
+#ifndef __CPU_HAS_EXCLUSIVE_ACCESS__
+#   define __CPU_HAS_EXCLUSIVE_ACCESS__ false
+#endif
+
 /*============================ MACROFIED FUNCTIONS ===========================*/
+#if __CPU_HAS_EXCLUSIVE_ACCESS__
+#if __IS_COMPILER_IAR__
+#   define LOAD_EXCLUSIVE(__PTR)            __LDREX((unsigned long *)(__PTR))
+#   define STORE_EXCLUSIVE(__PTR, __VALUE)  \
+                __STREX((__VALUE), (unsigned long *)(__PTR))
+#   define CLEAR_EXCLUSIVE()                __CLREX()
+#elif __IS_COMPILER_MDK__
+#   define LOAD_EXCLUSIVE(__PTR)            __ldrex(__PTR)
+#   define STORE_EXCLUSIVE(__PTR, __VALUE)  __strex((__VALUE), (__PTR))
+#   define CLEAR_EXCLUSIVE()                __clrex()
+#else
+#   define LOAD_EXCLUSIVE(__PTR)            load_exclusive(__PTR)
+#   define STORE_EXCLUSIVE(__PTR, __VALUE)  store_exclusive((__PTR), (__VALUE))
+#   define CLEAR_EXCLUSIVE()                __asm__ __volatile__ ("clrex" ::: "memory")
+#endif
+#endif
+
+#if USE_ATOM_PROFILE == ENABLED && ATOM_PROFILE_BUCKETS > 16
+#   error ATOM_PROFILE_BUCKETS should be 16 at most
+#endif
+
 /*============================ TYPES =========================================*/
 /*============================ GLOBAL VARIABLES ==============================*/
 /*============================ LOCAL VARIABLES ===============================*/
+#if USE_ATOM_PROFILE == ENABLED
+//! call sites recorded
+static atom_profile_t *s_ptAtomProfile = NULL;
+#endif
+
 /*============================ PROTOTYPES ====================================*/
 /*============================ IMPLEMENTATION ================================*/
 
+#if __CPU_HAS_EXCLUSIVE_ACCESS__ && __IS_COMPILER_GCC__
+static IN_LINE uint32_t load_exclusive(volatile uint32_t *pwTarget)
+{
+    uint32_t wResult;
+    __asm__ __volatile__ (
+        "ldrex %0, [%1]" : "=r" (wResult) : "r" (pwTarget) : "memory");
+    return wResult;
+}
+
+static IN_LINE uint32_t store_exclusive(
+    volatile uint32_t *pwTarget, uint32_t wValue)
+{
+    uint32_t wResult;
+    __asm__ __volatile__ (
+        "strex %0, %2, [%1]" 
+        : "=&r" (wResult) : "r" (pwTarget), "r" (wValue) : "memory");
+    return wResult;
+}
+#endif
+
 /*! \brief try to enter a section
  *! \param ptLock locker object
  *! \retval lock section is entered
@@ -69,5 +119,124 @@ void leave_lock(locker_t *ptLock)
     )
 }
 
+/*! \brief compare and swap a 32bit word
+ *! \param pwTarget target word
+ *! \param wOld the value the target is expected to hold
+ *! \param wNew the new value
+ *! \retval true the target held wOld and it is replaced by wNew
+ *! \retval false the target is changed by someone else, nothing is written
+ */
+bool atom_cas_u32(volatile uint32_t *pwTarget, uint32_t wOld, uint32_t wNew)
+{
+#if __CPU_HAS_EXCLUSIVE_ACCESS__
+    do {
+        if (LOAD_EXCLUSIVE(pwTarget) != wOld) {
+            CLEAR_EXCLUSIVE();
+            return false;
+        }
+        //! an interrupt between the two clears the monitor, so just retry
+    } while (0 != STORE_EXCLUSIVE(pwTarget, wNew));
+
+    return true;
+#else
+    bool bResult = false;
+    SAFE_ATOM_CODE(
+        if (*pwTarget == wOld) {
+            *pwTarget = wNew;
+            bResult = true;
+        }
+    )
+
+    return bResult;
+#endif
+}
+
+#if USE_ATOM_PROFILE == ENABLED
+/*! \brief start the time source of the profile, e.g. the DWT cycle counter
+ *! \param none
+ *! \return none
+ */
+void atom_profile_init(void)
+{
+#if __CPU_HAS_CYCLE_COUNTER__
+    (*(volatile uint32_t *)0xE000EDFC) |= _BV(24);  //!< DEMCR.TRCENA
+    (*(volatile uint32_t *)0xE0001000) |= _BV(0);   //!< DWT_CTRL.CYCCNTENA
+#endif
+}
+
+/*! \brief record a critical section, it is called by the section itself with
+ *!        the interrupts masked
+ *! \param ptSite profile of the call site
+ *! \param wStart tick the section started
+ *! \return none
+ */
+void atom_profile_record(atom_profile_t *ptSite, uint32_t wStart)
+{
+    uint32_t wNow = ATOM_PROFILE_GET_TICK();
+    uint32_t wElapsed, wLimit = 4;
+    uint_fast8_t chBucket = 0;
+
+#if defined(ATOM_PROFILE_TICK_PERIOD)
+    //! the tick counts down and reloads
+    if (wStart >= wNow) {
+        wElapsed = wStart - wNow;
+    } else {
+        wElapsed = wStart + ATOM_PROFILE_TICK_PERIOD() - wNow;
+    }
+#else
+    wElapsed = wNow - wStart;
+#endif
+
+    if (!ptSite->bRecorded) {
+        ptSite->bRecorded = true;
+        ptSite->ptNext = s_ptAtomProfile;
+        s_ptAtomProfile = ptSite;
+    }
+
+    ptSite->wCount++;
+    if (wElapsed > ptSite->wWorst) {
+        ptSite->wWorst = wElapsed;
+    }
+    while ((chBucket < ATOM_PROFILE_BUCKETS - 1) && (wElapsed >= wLimit)) {
+        chBucket++;
+        wLimit <<= 2;
+    }
+    ptSite->wHistogram[chBucket]++;
+}
+
+/*! \brief walk through the call sites recorded
+ *! \param ptSite current call site, NULL for the first one
+ *! \return the next call site, NULL for no more
+ */
+atom_profile_t *atom_profile_next(atom_profile_t *ptSite)
+{
+    if (NULL == ptSite) {
+        return s_ptAtomProfile;
+    }
+
+    return ptSite->ptNext;
+}
+
+/*! \brief clear the records of all call sites
+ *! \param none
+ *! \return none
+ */
+void atom_profile_reset(void)
+{
+    atom_profile_t *ptSite;
+    uint_fast8_t chBucket;
+
+    for (ptSite = s_ptAtomProfile; NULL != ptSite; ptSite = ptSite->ptNext) {
+        SAFE_ATOM_CODE(
+            ptSite->wCount = 0;
+            ptSite->wWorst = 0;
+            for (chBucket = 0; chBucket < ATOM_PROFILE_BUCKETS; chBucket++) {
+                ptSite->wHistogram[chBucket] = 0;
+            }
+        )
+    }
+}
+#endif
+
 /* EOF */
 
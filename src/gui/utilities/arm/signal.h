@@ -22,26 +22,86 @@
 
 /*============================ INCLUDES ======================================*/
 /*============================ MACROS ========================================*/
+//! \brief the cores without the DWT cycle counter, e.g. Cortex-M0, leave it
+//!        undefined
+#ifndef __CPU_HAS_CYCLE_COUNTER__
+#   define __CPU_HAS_CYCLE_COUNTER__    false
+#endif
+
+//! \brief record how long each critical section masks the interrupts, it 
+//!        costs a few bytes of RAM and tens of cycles per section
+#ifndef USE_ATOM_PROFILE
+#   define USE_ATOM_PROFILE             DISABLED
+#endif
+
+#if USE_ATOM_PROFILE == ENABLED
+//! \brief number of histogram buckets, bucket n counts the sections shorter
+//!        than 4^(n+1) ticks and the last one counts the rest
+#ifndef ATOM_PROFILE_BUCKETS
+#   define ATOM_PROFILE_BUCKETS         8
+#endif
+
+//! \brief time source of the profile, a port could define its own
+#ifndef ATOM_PROFILE_GET_TICK
+#   if __CPU_HAS_CYCLE_COUNTER__
+//! DWT CYCCNT, it is started by atom_profile_init()
+#       define ATOM_PROFILE_GET_TICK()      (*(volatile uint32_t *)0xE0001004)
+#   else
+//! SysTick VAL, it counts down from LOAD, so a section should be shorter than
+//! a SysTick period
+#       define ATOM_PROFILE_GET_TICK()      (*(volatile uint32_t *)0xE000E018)
+#       define ATOM_PROFILE_TICK_PERIOD()   ((*(volatile uint32_t *)0xE000E014) + 1)
+#   endif
+#endif
+
+#define __ATOM_PROFILE_BEGIN                                                \
+            static atom_profile_t s_tAtomProfile = {                        \
+                .pchFile = __FILE__,                                        \
+                .wLine = __LINE__,                                          \
+            };                                                              \
+            uint32_t wAtomProfileStart;
+#define __ATOM_PROFILE_START()                                              \
+            (wAtomProfileStart = ATOM_PROFILE_GET_TICK())
+#define __ATOM_PROFILE_STOP()                                               \
+            atom_profile_record(&s_tAtomProfile, wAtomProfileStart)
+#else
+#define __ATOM_PROFILE_BEGIN
+#define __ATOM_PROFILE_START()
+#define __ATOM_PROFILE_STOP()
+#endif
+
 //! \brief The safe ATOM code section macro
 # define SAFE_ATOM_CODE(...)     {\
+        __ATOM_PROFILE_BEGIN\
         istate_t tState = GET_GLOBAL_INTERRUPT_STATE();\
         DISABLE_GLOBAL_INTERRUPT();\
+        __ATOM_PROFILE_START();\
         __VA_ARGS__;\
+        __ATOM_PROFILE_STOP();\
         SET_GLOBAL_INTERRUPT_STATE(tState);\
     }
 
 //! \brief Exit from the safe atom operations
-# define EXIT_SAFE_ATOM_CODE()          SET_GLOBAL_INTERRUPT_STATE(tState);
+# define EXIT_SAFE_ATOM_CODE()          do {\
+                __ATOM_PROFILE_STOP();\
+                SET_GLOBAL_INTERRUPT_STATE(tState);\
+            } while(false);
 
 //! \brief ATOM code section macro
 # define ATOM_CODE(...)      {\
+                __ATOM_PROFILE_BEGIN\
                 DISABLE_GLOBAL_INTERRUPT();\
+                __ATOM_PROFILE_START();\
                 __VA_ARGS__;\
+                __ATOM_PROFILE_STOP();\
                 ENABLE_GLOBAL_INTERRUPT();\
             }
 
 //! \brief Exit from the atom operations
-# define EXIT_ATOM_CODE()   ENABLE_GLOBAL_INTERRUPT();
+# define EXIT_ATOM_CODE()   do {\
+                __ATOM_PROFILE_STOP();\
+                ENABLE_GLOBAL_INTERRUPT();\
+            } while(false);
 
 //! \name ES_LOCKER value
 //! @{
@@ -49,19 +109,25 @@
 #define UNLOCKED        false           //!< unlocked
 //! @}
 
-//! \note critical code section protection
+//! \note critical code section protection, the profile covers the part with
+//!       the interrupts masked only
 //! \param __LOCKER ES_LOCKER variable
 //! \param __CODE   target code segment
 #define LOCK(__LOCKER,...)  \
             {\
+                __ATOM_PROFILE_BEGIN\
                 istate_t tState = GET_GLOBAL_INTERRUPT_STATE();\
                 locker_t *pLocker = &(__LOCKER);\
                 DISABLE_GLOBAL_INTERRUPT();\
+                __ATOM_PROFILE_START();\
                 if (!(*pLocker)) {\
                     (*pLocker) = LOCKED;\
+                    __ATOM_PROFILE_STOP();\
                     ENABLE_GLOBAL_INTERRUPT();\
                     __VA_ARGS__;\
                     (*pLocker) = UNLOCKED;\
+                } else {\
+                    __ATOM_PROFILE_STOP();\
                 }\
                 SET_GLOBAL_INTERRUPT_STATE(tState);\
             }
@@ -95,10 +161,35 @@
                     }\
                 )\
             }
+
+/*! \note compare and swap a 32bit word. It is lock-free on the cores with
+ *!       exclusive access and masks the interrupts for a few instructions
+ *!       on the others. A port can define its own version.
+ */
+#ifndef ATOM_CAS_U32
+#define ATOM_CAS_U32(__PTR, __OLD, __NEW)   \
+            atom_cas_u32((__PTR), (__OLD), (__NEW))
+#endif
 /*============================ MACROFIED FUNCTIONS ===========================*/
 /*============================ TYPES =========================================*/
 typedef volatile bool locker_t;
 
+#if USE_ATOM_PROFILE == ENABLED
+//! \name profile of a critical section, one for each call site
+//! @{
+typedef struct atom_profile_t atom_profile_t;
+struct atom_profile_t {
+    const char          *pchFile;       //!< call site
+    uint32_t            wLine;          //!< call site
+    atom_profile_t      *ptNext;        //!< next call site recorded
+    bool                bRecorded;      //!< whether it is linked
+    uint32_t            wCount;         //!< number of times it was run
+    uint32_t            wWorst;         //!< the longest in ticks
+    uint32_t            wHistogram[ATOM_PROFILE_BUCKETS];
+};
+//! @}
+#endif
+
 /*============================ GLOBAL VARIABLES ==============================*/
 /*============================ LOCAL VARIABLES ===============================*/
 /*============================ PROTOTYPES ====================================*/
@@ -115,4 +206,42 @@ extern bool enter_lock(locker_t *ptLock);
  *! \return none
  */
 extern void leave_lock(locker_t *ptLock);
+
+/*! \brief compare and swap a 32bit word
+ *! \param pwTarget target word
+ *! \param wOld the value the target is expected to hold
+ *! \param wNew the new value
+ *! \retval true the target held wOld and it is replaced by wNew
+ *! \retval false the target is changed by someone else, nothing is written
+ */
+extern bool atom_cas_u32(
+    volatile uint32_t *pwTarget, uint32_t wOld, uint32_t wNew);
+
+#if USE_ATOM_PROFILE == ENABLED
+/*! \brief start the time source of the profile, e.g. the DWT cycle counter
+ *! \param none
+ *! \return none
+ */
+extern void atom_profile_init(void);
+
+/*! \brief record a critical section, it is called by the section itself with
+ *!        the interrupts masked
+ *! \param ptSite profile of the call site
+ *! \param wStart tick the section started
+ *! \return none
+ */
+extern void atom_profile_record(atom_profile_t *ptSite, uint32_t wStart);
+
+/*! \brief walk through the call sites recorded
+ *! \param ptSite current call site, NULL for the first one
+ *! \return the next call site, NULL for no more
+ */
+extern atom_profile_t *atom_profile_next(atom_profile_t *ptSite);
+
+/*! \brief clear the records of all call sites
+ *! \param none
+ *! \return none
+ */
+extern void atom_profile_reset(void);
+#endif
 #endif
@@ -27,6 +27,12 @@
     #define NOP()               __asm__ __volatile__ ("nop");
 #endif
 
+//! \brief memory accesses are not moved across it, the core does not 
+//!        reorder them
+#ifndef MEMORY_BARRIER
+    #define MEMORY_BARRIER()    __asm__ __volatile__ ("" ::: "memory")
+#endif
+
 
 //! ALU integer width in byte
 # define ATOM_INT_SIZE           1
@@ -38,6 +44,9 @@
 //! \brief The mcu memory endian mode
 # define __BIG_ENDIAN__         false
 
+//! \brief the core has no cycle counter
+# define __CPU_HAS_CYCLE_COUNTER__  false
+
 
 //! \brief none standard memory types
 #if __IS_COMPILER_IAR__
@@ -46,12 +55,14 @@
     # define NO_INIT    __no_init
     # define ROOT       __root
     # define RAM
+    # define IN_LINE    inline
 #elif __IS_COMPILER_GCC__
     # define FLASH		const
     # define EEPROM     const
     # define NO_INIT
     # define ROOT       
     # define RAM
+    # define IN_LINE    inline
 #endif
 
 
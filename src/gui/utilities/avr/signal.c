@@ -0,0 +1,59 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+
+/*============================ INCLUDES ======================================*/
+#ifndef __STORE_ENVIRONMENT_CFG_IN_PROJ__
+#include "..\..\..\environment_cfg.h"
+#endif
+
+#include "..\compiler.h"
+
+/*============================ MACROS ========================================*/
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+/*============================ IMPLEMENTATION ================================*/
+
+#if defined(__CPU_AVR__)
+/*! \brief compare and swap a 32bit word
+ *! \param pwTarget target word
+ *! \param wOld the value the target is expected to hold
+ *! \param wNew the new value
+ *! \retval true the target held wOld and it is replaced by wNew
+ *! \retval false the target is changed by someone else, nothing is written
+ */
+bool atom_cas_u32(volatile uint32_t *pwTarget, uint32_t wOld, uint32_t wNew)
+{
+    bool bResult = false;
+    SAFE_ATOM_CODE(
+        if (*pwTarget == wOld) {
+            *pwTarget = wNew;
+            bResult = true;
+        }
+    )
+
+    return bResult;
+}
+#endif
+
+/* EOF */
@@ -125,6 +125,14 @@
                 )\
             }
 
+/*! \note compare and swap a 32bit word, the interrupts are masked during
+ *!       the few instructions it takes
+ */
+#ifndef ATOM_CAS_U32
+#define ATOM_CAS_U32(__PTR, __OLD, __NEW)   \
+            atom_cas_u32((__PTR), (__OLD), (__NEW))
+#endif
+
 /*============================ TYPES =========================================*/
 typedef volatile bool locker_t;
 
@@ -132,6 +140,17 @@ typedef volatile bool locker_t;
 /*============================ GLOBAL VARIABLES ==============================*/
 /*============================ LOCAL VARIABLES ===============================*/
 /*============================ PROTOTYPES ====================================*/
+
+/*! \brief compare and swap a 32bit word
+ *! \param pwTarget target word
+ *! \param wOld the value the target is expected to hold
+ *! \param wNew the new value
+ *! \retval true the target held wOld and it is replaced by wNew
+ *! \retval false the target is changed by someone else, nothing is written
+ */
+extern bool atom_cas_u32(
+    volatile uint32_t *pwTarget, uint32_t wOld, uint32_t wNew);
+
 /*============================ IMPLEMENTATION ================================*/
 
 
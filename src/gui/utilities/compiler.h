@@ -69,7 +69,9 @@
 #include ".\preprocessor\mrepeat.h"
      
 //! \brief CPU io
-#if     defined(__CPU_ARM__)                    //!< ARM series
+#if     defined(__CPU_HOST__)                   //!< host build for testing
+    #include ".\host\host_compiler.h"
+#elif   defined(__CPU_ARM__)                    //!< ARM series
     #include ".\arm\arm_compiler.h"
 #elif   defined(__CPU_AVR__)                    //!< Atmel AVR series
     #include ".\avr\avr_compiler.h"
@@ -0,0 +1,131 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __UTILITIES_COROUTINE_H__
+#define __UTILITIES_COROUTINE_H__
+
+/*============================ INCLUDES ======================================*/
+/*============================ MACROS ========================================*/
+/*============================ MACROFIED FUNCTIONS ===========================*/
+
+/*! \note  stackless coroutine, a function returning fsm_rt_t is written as 
+ *!        straight code and resumes where it waited last time.
+ *!
+ *!        - the context is a single resume word, 0 means not started
+ *!        - local variables do not survive AWAIT, use static ones
+ *!        - one AWAIT / TASK_YIELD per line, and none inside a switch
+ *!        - cleanup code given to TASK_END runs once on every exit, normal
+ *!          or by TASK_EXIT, but not when the task is waiting
+ *!
+ *!        static fsm_rt_t print(void)
+ *!        {
+ *!            static coroutine_t s_tTask = 0;
+ *!
+ *!            TASK_BEGIN(s_tTask)
+ *!                AWAIT(lock());
+ *!                if (error) {
+ *!                    TASK_EXIT(fsm_rt_err);   //!< unlock() is called
+ *!                }
+ *!                AWAIT_FSM(send());
+ *!            TASK_END(
+ *!                unlock();
+ *!            )
+ *!        }
+ */
+
+//! \brief begin the body of a coroutine with its context
+#define TASK_BEGIN(__CTX)                                                   \
+    {                                                                       \
+        coroutine_t *ptTaskResume = &(__CTX);                               \
+        fsm_rt_t tTaskResult = fsm_rt_cpl;                                  \
+        switch (*ptTaskResume) {                                            \
+            case 0:
+
+//! \brief wait until a condition is true, it is checked again on resume
+#define AWAIT(__COND)                                                       \
+            do {                                                            \
+                *ptTaskResume = __LINE__;                                   \
+            case __LINE__:                                                  \
+                if (!(__COND)) {                                            \
+                    return fsm_rt_on_going;                                 \
+                }                                                           \
+            } while(false)
+
+/*! \brief call a fsm until it is complete, the task exits with the error
+ *!        when the fsm fails
+ */
+#define AWAIT_FSM(__FSM)                                                    \
+            do {                                                            \
+                fsm_rt_t tTaskSub;                                          \
+                *ptTaskResume = __LINE__;                                   \
+            case __LINE__:                                                  \
+                tTaskSub = (__FSM);                                         \
+                if (IS_FSM_ERR(tTaskSub)) {                                 \
+                    TASK_EXIT(tTaskSub);                                    \
+                } else if (fsm_rt_cpl != tTaskSub) {                        \
+                    return fsm_rt_on_going;                                 \
+                }                                                           \
+            } while(false)
+
+//! \brief return fsm_rt_on_going and go on from here next time
+#define TASK_YIELD()                                                        \
+            do {                                                            \
+                *ptTaskResume = __LINE__;                                   \
+                return fsm_rt_on_going;                                     \
+            case __LINE__:                                                  \
+                ;                                                           \
+            } while(false)
+
+//! \brief leave the task with a result, the cleanup code runs
+#define TASK_EXIT(__RESULT)                                                 \
+            do {                                                            \
+                tTaskResult = (__RESULT);                                   \
+                goto __task_exit;                                           \
+            } while(false)
+
+/*! \brief leave the task with a result without the cleanup code, it is only
+ *!        for leaving before anything to clean is taken, e.g. bad parameters
+ */
+#define TASK_RETURN(__RESULT)                                               \
+            do {                                                            \
+                *ptTaskResume = 0;                                          \
+                return (__RESULT);                                          \
+            } while(false)
+
+//! \brief end the body of a coroutine, the arguments are the cleanup code
+#define TASK_END(...)                                                       \
+        }                                                                   \
+        goto __task_exit;                                                   \
+    __task_exit:                                                            \
+        *ptTaskResume = 0;                                                  \
+        __VA_ARGS__                                                         \
+        return tTaskResult;                                                 \
+    }
+
+/*============================ TYPES =========================================*/
+
+//! \brief coroutine context, the line number it waits at
+typedef uint16_t coroutine_t;
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+#endif
+/* EOF */
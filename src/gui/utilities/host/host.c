@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+/*============================ INCLUDES ======================================*/
+#ifndef __STORE_ENVIRONMENT_CFG_IN_PROJ__
+#include "..\..\..\environment_cfg.h"
+#endif
+
+#include "..\compiler.h"
+
+#if defined(__CPU_HOST__)
+#include <time.h>
+
+/*============================ MACROS ========================================*/
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+/*============================ GLOBAL VARIABLES ==============================*/
+//! global interrupt state of the host build
+volatile istate_t g_bHostInterruptEnabled = true;
+
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+/*============================ IMPLEMENTATION ================================*/
+
+/*! \brief get the monotonic time of the host
+ *! \param none
+ *! \return the time in nano seconds, it wraps around
+ */
+uint32_t host_get_tick(void)
+{
+    struct timespec tTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &tTime);
+
+    return (uint32_t)tTime.tv_sec * 1000000000ul + (uint32_t)tTime.tv_nsec;
+}
+
+#endif
+/* EOF */
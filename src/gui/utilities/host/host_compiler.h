@@ -0,0 +1,108 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef __USE_HOST_COMPILER_H__
+#define __USE_HOST_COMPILER_H__
+
+/*============================ INCLUDES ======================================*/
+#include <stdatomic.h>
+
+/*============================ MACROS ========================================*/
+
+//! ALU integer width in byte
+# define ATOM_INT_SIZE                  4
+
+//! \brief The mcu memory align mode
+# define MCU_MEM_ALIGN_SIZE             ATOM_INT_SIZE
+
+//! \brief The mcu memory endian mode
+# define __BIG_ENDIAN__                 false
+
+//! \brief 1 cycle nop operation
+#ifndef NOP
+    #define NOP()
+#endif
+
+//! \brief memory accesses before it complete before the ones after it
+#ifndef MEMORY_BARRIER
+    #define MEMORY_BARRIER()            atomic_thread_fence(memory_order_seq_cst)
+#endif
+
+//! \brief compare and swap a 32bit word with the C11 atomics
+#ifndef ATOM_CAS_U32
+    #define ATOM_CAS_U32(__PTR, __OLD, __NEW)                               \
+        atomic_compare_exchange_strong(                                     \
+            (volatile _Atomic uint32_t *)(__PTR), &(uint32_t){(__OLD)}, (__NEW))
+#endif
+
+//! \brief none standard memory types
+# define FLASH              const
+# define EEPROM             const
+# define NO_INIT
+# define ROOT               __attribute__((used))
+# define IN_LINE            inline
+# define WEAK               __attribute__((weak))
+# define RAMFUNC
+# define ALIGN(__N)         __attribute__((aligned (__N)))
+# define AT_ADDR(__ADDR)
+# define SECTION(__SEC)
+
+/*----------------------------------------------------------------------------*
+ * Signal & Interrupt Definition                                              *
+ *----------------------------------------------------------------------------*/
+//! \note a host build runs in a single thread, interrupts are played by
+//!       calling the interrupt handlers from the test code, so masking them
+//!       only has to keep the state for nested sections
+
+  /*!< Macro to enable all interrupts. */
+#define ENABLE_GLOBAL_INTERRUPT()       (g_bHostInterruptEnabled = true)
+
+  /*!< Macro to disable all interrupts. */
+#define DISABLE_GLOBAL_INTERRUPT()      (g_bHostInterruptEnabled = false)
+
+#define GET_GLOBAL_INTERRUPT_STATE()        (g_bHostInterruptEnabled)
+#define SET_GLOBAL_INTERRUPT_STATE(__STATE) (g_bHostInterruptEnabled = (__STATE))
+
+//! \brief time source of the critical section profile, in nano seconds
+#ifndef ATOM_PROFILE_GET_TICK
+#define ATOM_PROFILE_GET_TICK()             host_get_tick()
+#endif
+
+/*============================ TYPES =========================================*/
+/*============================ INCLUDES ======================================*/
+/*!  \note the host uses the same basic types as the arm port
+ */
+#include "..\arm\app_type.h"
+
+typedef bool istate_t;
+
+//! global interrupt state of the host build
+extern volatile istate_t g_bHostInterruptEnabled;
+
+/*! \brief get the monotonic time of the host
+ *! \param none
+ *! \return the time in nano seconds, it wraps around
+ */
+extern uint32_t host_get_tick(void);
+
+//! \brief for interrupt 
+#include "..\arm\signal.h"
+
+#endif
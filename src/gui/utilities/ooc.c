@@ -29,6 +29,16 @@
 
 #define this             (*ptThis)
 
+#define READY_LIST       (this.ptList[this.chReady])
+#define BLOCKED_LIST     (this.ptList[this.chReady ^ 1])
+
+//! \name delegate dispatch status
+//! @{
+#define DELEGATE_STATUS_PENDING         _BV(0)  //!< a post is not dispatched yet
+#define DELEGATE_STATUS_DISPATCHING     _BV(1)  //!< handlers are running
+#define DELEGATE_STATUS_FLAGS           _BV(2)  //!< posted by post_delegate_flags
+//! @}
+
 /*============================ MACROFIED FUNCTIONS ===========================*/
 /*============================ TYPES =========================================*/
 
@@ -36,10 +46,15 @@
 //! @{
 //DEF_CLASS(DELEGATE_HANDLE)
 typedef struct __delegate_handler CLASS(DELEGATE_HANDLE);
+typedef struct __delegate CLASS(DELEGATE);
 struct __delegate_handler {
     DELEGATE_HANDLE_FUNC    *fnHandler;         //!< event handler
     void                    *pArg;              //!< Argument
     CLASS(DELEGATE_HANDLE)  *ptNext;            //!< next 
+    CLASS(DELEGATE_HANDLE)  **pptPrev;          //!< the link pointing to it
+    CLASS(DELEGATE)         *ptOwner;           //!< NULL when not registered
+    uint8_t                 chList;             //!< the list of ptOwner it is in
+    uint8_t                 chPriority;         //!< larger runs earlier
 };
 //END_DEF_CLASS(DELEGATE_HANDLE)
 //! @}
@@ -47,11 +62,15 @@ struct __delegate_handler {
 //! \name event
 //! @{
 //EXTERN_CLASS(DELEGATE)
-typedef struct __delegate CLASS(DELEGATE);
 struct __delegate {
-    DELEGATE_HANDLE *ptEvent;
-    DELEGATE_HANDLE *ptBlockedList;
-    CLASS(DELEGATE_HANDLE) **pptHandler;
+    CLASS(DELEGATE_HANDLE)  *ptList[2];         //!< ready list and blocked list
+    CLASS(DELEGATE_HANDLE)  **pptHandler;
+    uint8_t                 chReady;            //!< index of the ready list
+    volatile uint8_t        chStatus;           //!< DELEGATE_STATUS_xxx
+    void                    *pParam;            //!< parameter being dispatched
+    void                    *pPending;          //!< parameter of the next dispatch
+    uint32_t                wFlags;             //!< flags being dispatched
+    uint32_t                wPendingFlags;      //!< flags of the next dispatch
 };
 //END_EXTERN_CLASS(DELEGATE)
 //! @}
@@ -73,9 +92,15 @@ DELEGATE *delegate_init(DELEGATE *ptEvent)
             break;
         }
 
-        this.ptEvent = NULL;
-        this.ptBlockedList = NULL;
-        this.pptHandler = (CLASS(DELEGATE_HANDLE) **)&(this.ptEvent);
+        this.ptList[0] = NULL;
+        this.ptList[1] = NULL;
+        this.chReady = 0;
+        this.pptHandler = &(READY_LIST);
+        this.chStatus = 0;
+        this.pParam = NULL;
+        this.pPending = NULL;
+        this.wFlags = 0;
+        this.wPendingFlags = 0;
         
     } while (0);
 
@@ -99,22 +124,88 @@ DELEGATE_HANDLE *delegate_handler_init(
     ptHND->fnHandler = fnRoutine;
     ptHND->pArg = pArg;
     ptHND->ptNext = NULL;
+    ptHND->pptPrev = NULL;
+    ptHND->ptOwner = NULL;
+    ptHND->chList = 0;
+    ptHND->chPriority = 0;
 
     return ptHandler;
 }
 
+/*! \brief set the priority of an event handler item, the handlers with larger
+ *!        priority run earlier. It should be set before registering.
+ *! \param ptHandler the target event handler item
+ *! \param chPriority priority, 0 by default
+ *! \return the address of event handler item, NULL when it is registered
+ */
+DELEGATE_HANDLE *delegate_handler_set_priority(
+    DELEGATE_HANDLE *ptHandler, uint_fast8_t chPriority)
+{
+    CLASS(DELEGATE_HANDLE) *ptHND = (CLASS(DELEGATE_HANDLE) *)ptHandler;
+    if (NULL == ptHandler || NULL != ptHND->ptOwner) {
+        return NULL;
+    }
+    ptHND->chPriority = chPriority;
 
-static CLASS(DELEGATE_HANDLE) **search_list(
-    CLASS(DELEGATE_HANDLE) **pptHandler, CLASS(DELEGATE_HANDLE) *ptHND)
+    return ptHandler;
+}
+
+/*! \brief add a handler to the specified list in front of the handlers with
+ *!        the same or lower priority, so it is the head when all handlers
+ *!        have the same priority
+ */
+static void list_insert(
+    CLASS(DELEGATE) *ptThis, uint_fast8_t chList, CLASS(DELEGATE_HANDLE) *ptHND)
 {
-    //! search event handler chain
-    while (NULL != (*pptHandler)) {
-        if ((*pptHandler) == ptHND) {
-            return pptHandler;
-        }
-        pptHandler = &((*pptHandler)->ptNext);      //!< get next item
+    CLASS(DELEGATE_HANDLE) **pptList = &(this.ptList[chList]);
+
+    while ((NULL != (*pptList)) && ((*pptList)->chPriority > ptHND->chPriority)) {
+        pptList = &((*pptList)->ptNext);
+    }
+
+    ptHND->ptNext = (*pptList);
+    if (NULL != ptHND->ptNext) {
+        ptHND->ptNext->pptPrev = &(ptHND->ptNext);
+    }
+    ptHND->pptPrev = pptList;
+    (*pptList) = ptHND;
+
+    ptHND->ptOwner = ptThis;
+    ptHND->chList = chList;
+}
+
+//! \brief remove a handler from the list it is in
+static void list_remove(CLASS(DELEGATE) *ptThis, CLASS(DELEGATE_HANDLE) *ptHND)
+{
+    //! keep the cursor of invoke_delegate on the same item
+    if (this.pptHandler == &(ptHND->ptNext)) {
+        this.pptHandler = ptHND->pptPrev;
+    }
+
+    (*ptHND->pptPrev) = ptHND->ptNext;
+    if (NULL != ptHND->ptNext) {
+        ptHND->ptNext->pptPrev = ptHND->pptPrev;
     }
-    return NULL;
+
+    ptHND->ptNext = NULL;
+    ptHND->pptPrev = NULL;
+    ptHND->ptOwner = NULL;
+}
+
+/*! \brief call an event handler directly, e.g. for a callback which is not
+ *!        shared by a delegate
+ *! \param ptHandler the target event handler
+ *! \param pParam event parameter
+ *! \return the result of the handler routine
+ */
+fsm_rt_t call_delegate_handler(DELEGATE_HANDLE *ptHandler, void *pParam)
+{
+    CLASS(DELEGATE_HANDLE) *ptHND = (CLASS(DELEGATE_HANDLE) *)ptHandler;
+    if ((NULL == ptHandler) || (NULL == ptHND->fnHandler)) {
+        return (fsm_rt_t)GSF_ERR_INVALID_PTR;
+    }
+
+    return ptHND->fnHandler(ptHND->pArg, pParam);
 }
 
 /*! \brief register event handler to specified event
@@ -128,23 +219,16 @@ gsf_err_t register_delegate_handler(DELEGATE *ptEvent, DELEGATE_HANDLE *ptHandle
     CLASS(DELEGATE_HANDLE) *ptHND = (CLASS(DELEGATE_HANDLE) *)ptHandler;
     if ((NULL == ptEvent) || (NULL == ptHandler) || (NULL == ptHND->fnHandler)) {
         return GSF_ERR_INVALID_PTR;
-    } else if (NULL != ptHND->ptNext) {     
-        //! search ready list
-        CLASS(DELEGATE_HANDLE) **pptHandler = search_list(   
-            (CLASS(DELEGATE_HANDLE) **)&(this.ptBlockedList), ptHND );
-
-        if (NULL != pptHandler) {
-            //! safe to remove
-            (*pptHandler) = ptHND->ptNext;
-            ptHND->ptNext = NULL;
-        } else {        
+    } else if (NULL != ptHND->ptOwner) {     
+        if ((ptThis != ptHND->ptOwner) || (this.chReady == ptHND->chList)) {
             return GSF_ERR_REQ_ALREADY_REGISTERED;
         }
+        //! it is blocked, move it back to the ready list
+        list_remove(ptThis, ptHND);
     }
 
     //! add handler to the ready list
-    ptHND->ptNext = (CLASS(DELEGATE_HANDLE) *)(this.ptEvent);
-    this.ptEvent = ptHandler;
+    list_insert(ptThis, this.chReady, ptHND);
 
     return GSF_ERR_NONE;
 }
@@ -160,51 +244,26 @@ gsf_err_t unregister_delegate_handler( DELEGATE *ptEvent, DELEGATE_HANDLE *ptHan
 {
     CLASS(DELEGATE) *ptThis = (CLASS(DELEGATE) *)ptEvent;
     CLASS(DELEGATE_HANDLE) *ptHND = (CLASS(DELEGATE_HANDLE) *)ptHandler;
-    CLASS(DELEGATE_HANDLE) **pptHandler;
     if ((NULL == ptEvent) || (NULL == ptHandler)) {
         return GSF_ERR_INVALID_PTR;
     } 
 
-    do {
-        //! search ready list
-        pptHandler = search_list(   (CLASS(DELEGATE_HANDLE) **)&(this.ptEvent), 
-                                    ptHND );
-        if (NULL != pptHandler) {
-            //! safe to remove
-            (*pptHandler) = ptHND->ptNext;
-            ptHND->ptNext = NULL;
-            if (this.pptHandler == &(ptHND->ptNext)) {
-                this.pptHandler = pptHandler;
-            }
-            break;
-        }
-        //! search ready list
-        pptHandler = search_list(   (CLASS(DELEGATE_HANDLE) **)&(this.ptBlockedList), 
-                                    ptHND );
-        if (NULL != pptHandler) {
-            //! safe to remove
-            (*pptHandler) = ptHND->ptNext;
-            ptHND->ptNext = NULL;
-            if (this.pptHandler == &(ptHND->ptNext)) {
-                this.pptHandler = pptHandler;
-            }
-            break;
-        }
-    } while(false);
+    if (ptThis == ptHND->ptOwner) {
+        //! safe to remove
+        list_remove(ptThis, ptHND);
+    }
     
     return GSF_ERR_NONE;
 }
 
 static fsm_rt_t __move_to_block_list(CLASS(DELEGATE) *ptThis, CLASS(DELEGATE_HANDLE) *ptHandler)
 {
-    CLASS(DELEGATE_HANDLE) *ptHND = ptHandler;
     //! remove handler from ready list
-    (*this.pptHandler) = ptHND->ptNext;
+    list_remove(ptThis, ptHandler);
     //! add handler to block list
-    ptHND->ptNext = (CLASS(DELEGATE_HANDLE) *)this.ptBlockedList;
-    this.ptBlockedList = (DELEGATE_HANDLE *)ptHND;
+    list_insert(ptThis, this.chReady ^ 1, ptHandler);
 
-    if (NULL == this.ptEvent) {
+    if (NULL == READY_LIST) {
         return fsm_rt_cpl;
     }
 
@@ -228,21 +287,20 @@ fsm_rt_t invoke_delegate( DELEGATE *ptEvent, void *pParam)
         return (fsm_rt_t)GSF_ERR_INVALID_PTR;
     }
 
-    if (NULL == this.ptEvent) {
-        if (NULL == this.ptBlockedList) {
+    if (NULL == READY_LIST) {
+        if (NULL == BLOCKED_LIST) {
             //! nothing to do
             return fsm_rt_cpl;
         }
         
-        //! initialize state
-        this.ptEvent = this.ptBlockedList;
-        this.ptBlockedList = NULL;
-        this.pptHandler = (CLASS(DELEGATE_HANDLE) **)&(this.ptEvent);
+        //! initialize state, the blocked list becomes the ready list
+        this.chReady ^= 1;
+        this.pptHandler = &(READY_LIST);
     } 
 
     if (NULL == (*this.pptHandler)) {
         //! finish visiting the ready list
-        this.pptHandler = (CLASS(DELEGATE_HANDLE) **)&(this.ptEvent);
+        this.pptHandler = &(READY_LIST);
         if (NULL == (*this.pptHandler)) {
             //! complete
             return fsm_rt_cpl;
@@ -258,9 +316,7 @@ fsm_rt_t invoke_delegate( DELEGATE *ptEvent, void *pParam)
                 this.pptHandler = &(ptHandler->ptNext);    //!< get next item
             } else if (EVENT_RT_UNREGISTER == tFSM) {
                 //! return EVENT_RT_UNREGISTER means event handler could be removed
-                CLASS(DELEGATE_HANDLE) *ptHND = ptHandler;
-                (*this.pptHandler) = ptHND->ptNext;
-                ptHND->ptNext = NULL;
+                list_remove(ptThis, ptHandler);
             } else {
                 return __move_to_block_list(ptThis, ptHandler);
             }
@@ -273,6 +329,105 @@ fsm_rt_t invoke_delegate( DELEGATE *ptEvent, void *pParam)
 }
 
 
+/*! \brief post an event to be dispatched by dispatch_delegate. Posts before
+ *!        the dispatch starts are coalesced, the last parameter wins. It
+ *!        could be called in an ISR.
+ *! \param ptEvent the target event
+ *! \param pParam event parameter
+ *! \return access result
+ */
+gsf_err_t post_delegate(DELEGATE *ptEvent, void *pParam)
+{
+    CLASS(DELEGATE) *ptThis = (CLASS(DELEGATE) *)ptEvent;
+    if (NULL == ptEvent) {
+        return GSF_ERR_INVALID_PTR;
+    }
+
+    SAFE_ATOM_CODE(
+        this.pPending = pParam;
+        this.chStatus |= DELEGATE_STATUS_PENDING;
+        this.chStatus &= ~DELEGATE_STATUS_FLAGS;
+    )
+
+    return GSF_ERR_NONE;
+}
+
+/*! \brief post event flags to be dispatched by dispatch_delegate. Posts before
+ *!        the dispatch starts are merged, the handlers get the address of a
+ *!        uint32_t with all the flags as parameter. It could be called in an
+ *!        ISR.
+ *! \param ptEvent the target event
+ *! \param wFlags event flags
+ *! \return access result
+ */
+gsf_err_t post_delegate_flags(DELEGATE *ptEvent, uint32_t wFlags)
+{
+    CLASS(DELEGATE) *ptThis = (CLASS(DELEGATE) *)ptEvent;
+    if (NULL == ptEvent) {
+        return GSF_ERR_INVALID_PTR;
+    }
+
+    SAFE_ATOM_CODE(
+        this.wPendingFlags |= wFlags;
+        this.chStatus |= DELEGATE_STATUS_PENDING | DELEGATE_STATUS_FLAGS;
+    )
+
+    return GSF_ERR_NONE;
+}
+
+/*! \brief dispatch the posted event, every handler runs once in priority order
+ *!        for a burst of posts. The posts during a dispatch are dispatched
+ *!        in the next round.
+ *! \param ptEvent the target event
+ *! \retval fsm_rt_on_going the dispatch is not finished
+ *! \retval fsm_rt_cpl nothing is pending
+ */
+fsm_rt_t dispatch_delegate(DELEGATE *ptEvent)
+{
+    CLASS(DELEGATE) *ptThis = (CLASS(DELEGATE) *)ptEvent;
+    fsm_rt_t tFSM;
+    bool bPending;
+    if (NULL == ptEvent) {
+        return (fsm_rt_t)GSF_ERR_INVALID_PTR;
+    }
+
+    if (!(this.chStatus & DELEGATE_STATUS_DISPATCHING)) {
+        bool bStart = false;
+        SAFE_ATOM_CODE(
+            if (this.chStatus & DELEGATE_STATUS_PENDING) {
+                if (this.chStatus & DELEGATE_STATUS_FLAGS) {
+                    this.wFlags = this.wPendingFlags;
+                    this.wPendingFlags = 0;
+                    this.pParam = &(this.wFlags);
+                } else {
+                    this.pParam = this.pPending;
+                }
+                this.chStatus &= ~(DELEGATE_STATUS_PENDING | DELEGATE_STATUS_FLAGS);
+                this.chStatus |= DELEGATE_STATUS_DISPATCHING;
+                bStart = true;
+            }
+        )
+        if (!bStart) {
+            return fsm_rt_cpl;
+        }
+    }
+
+    tFSM = invoke_delegate(ptEvent, this.pParam);
+    if (fsm_rt_on_going == tFSM) {
+        return fsm_rt_on_going;
+    } 
+
+    //! a post from ISR could update the status meanwhile
+    SAFE_ATOM_CODE(
+        this.chStatus &= ~DELEGATE_STATUS_DISPATCHING;
+        bPending = (0 != (this.chStatus & DELEGATE_STATUS_PENDING));
+    )
+    if (bPending) {
+        return fsm_rt_on_going;
+    }
+
+    return tFSM;
+}
 
 
 /* EOF */
@@ -120,15 +120,24 @@ EXTERN_CLASS( DELEGATE_HANDLE,
     DELEGATE_HANDLE_FUNC   *fnHandler;      //!< event handler
     void                   *pArg;           //!< Argument
     DELEGATE_HANDLE        *ptNext;         //!< next 
+    DELEGATE_HANDLE        **pptPrev;       //!< the link pointing to it
+    void                   *ptOwner;        //!< NULL when not registered
+    uint8_t                chList;          //!< the list of ptOwner it is in
+    uint8_t                chPriority;      //!< larger runs earlier
 END_EXTERN_CLASS(DELEGATE_HANDLE)
 //! @}
 
 //! \name event
 //! @{
 EXTERN_CLASS(DELEGATE)
-    DELEGATE_HANDLE     *ptEvent;
-    DELEGATE_HANDLE     *ptBlockedList;
+    DELEGATE_HANDLE     *ptList[2];         //!< ready list and blocked list
     DELEGATE_HANDLE     **pptHandler;
+    uint8_t             chReady;            //!< index of the ready list
+    volatile uint8_t    chStatus;
+    void                *pParam;
+    void                *pPending;
+    uint32_t            wFlags;
+    uint32_t            wPendingFlags;
 END_EXTERN_CLASS(DELEGATE)
 //! @}
 
@@ -217,6 +226,23 @@ extern DELEGATE *delegate_init(DELEGATE *ptEvent);
 extern DELEGATE_HANDLE *delegate_handler_init(
     DELEGATE_HANDLE *ptHandler, DELEGATE_HANDLE_FUNC *fnRoutine, void *pArg);
 
+/*! \brief set the priority of an event handler item, the handlers with larger
+ *!        priority run earlier. It should be set before registering.
+ *! \param ptHandler the target event handler item
+ *! \param chPriority priority, 0 by default
+ *! \return the address of event handler item, NULL when it is registered
+ */
+extern DELEGATE_HANDLE *delegate_handler_set_priority(
+    DELEGATE_HANDLE *ptHandler, uint_fast8_t chPriority);
+
+/*! \brief call an event handler directly, e.g. for a callback which is not
+ *!        shared by a delegate
+ *! \param ptHandler the target event handler
+ *! \param pParam event parameter
+ *! \return the result of the handler routine
+ */
+extern fsm_rt_t call_delegate_handler(DELEGATE_HANDLE *ptHandler, void *pParam);
+
 /*! \brief register event handler to specified event
  *! \param ptEvent target event
  *! \param ptHandler target event handler
@@ -237,5 +263,33 @@ extern gsf_err_t unregister_delegate_handler( DELEGATE *ptEvent, DELEGATE_HANDLE
  *! \return access result
  */
 extern fsm_rt_t invoke_delegate( DELEGATE *ptEvent, void *pParam);
+
+/*! \brief post an event to be dispatched by dispatch_delegate. Posts before
+ *!        the dispatch starts are coalesced, the last parameter wins. It
+ *!        could be called in an ISR.
+ *! \param ptEvent the target event
+ *! \param pParam event parameter
+ *! \return access result
+ */
+extern gsf_err_t post_delegate(DELEGATE *ptEvent, void *pParam);
+
+/*! \brief post event flags to be dispatched by dispatch_delegate. Posts before
+ *!        the dispatch starts are merged, the handlers get the address of a
+ *!        uint32_t with all the flags as parameter. It could be called in an
+ *!        ISR.
+ *! \param ptEvent the target event
+ *! \param wFlags event flags
+ *! \return access result
+ */
+extern gsf_err_t post_delegate_flags(DELEGATE *ptEvent, uint32_t wFlags);
+
+/*! \brief dispatch the posted event, every handler runs once in priority order
+ *!        for a burst of posts. The posts during a dispatch are dispatched
+ *!        in the next round.
+ *! \param ptEvent the target event
+ *! \retval fsm_rt_on_going the dispatch is not finished
+ *! \retval fsm_rt_cpl nothing is pending
+ */
+extern fsm_rt_t dispatch_delegate(DELEGATE *ptEvent);
 #endif
 /* EOF */
\ No newline at end of file
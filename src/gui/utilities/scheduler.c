@@ -0,0 +1,402 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+/*============================ INCLUDES ======================================*/
+#ifndef __STORE_ENVIRONMENT_CFG_IN_PROJ__
+#include "..\..\environment_cfg.h"
+#endif
+
+#include ".\compiler.h"
+#include ".\scheduler.h"
+#include ".\timer_wheel.h"
+
+/*============================ MACROS ========================================*/
+
+#define this             (*ptThis)
+
+//! \name task status
+//! @{
+#define TASK_STATUS_REGISTERED      _BV(0)  //!< added to the scheduler
+#define TASK_STATUS_QUEUED          _BV(1)  //!< in the run queue
+#define TASK_STATUS_WATCHED         _BV(2)  //!< in the watch list
+#define TASK_STATUS_RUNNING         _BV(3)  //!< the routine is running
+#define TASK_STATUS_WOKEN           _BV(4)  //!< woken while running or watched
+//! @}
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+
+//! \name cooperative task
+//! @{
+//! \note a registered task is in the run queue, in the watch list when it 
+//!       waits for a condition or a period, or nowhere when it only waits 
+//!       for task_wake(). ptNext links it in the list it is in.
+typedef struct __task CLASS(task_t);
+struct __task {
+    task_routine_t          *fnRoutine;     //!< task routine
+    void                    *pArg;          //!< argument of fnRoutine
+    CLASS(task_t)           *ptNext;        //!< next task in the same list
+    task_condition_t        *fnCondition;   //!< wake condition, NULL for none
+    void                    *pTarget;       //!< argument of fnCondition
+    uint32_t                wPeriod;        //!< wake period, 0 for none
+    uint32_t                wDeadline;      //!< tick of the next periodic wake
+    DELEGATE_HANDLE         tWakeHandler;   //!< handler waking the task
+    DELEGATE                *ptEvent;       //!< delegate subscribed to
+    volatile uint8_t        chStatus;       //!< TASK_STATUS_xxx
+};
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+static CLASS(task_t) *s_ptReadyHead = NULL;     //!< run queue
+static CLASS(task_t) *s_ptReadyTail = NULL;
+static uint_fast16_t s_hwReadyCount = 0;
+static CLASS(task_t) *s_ptWatchList = NULL;     //!< waiting tasks being polled
+static volatile bool s_bWoken = false;          //!< a watched task is woken
+
+/*============================ PROTOTYPES ====================================*/
+/*============================ IMPLEMENTATION ================================*/
+
+/*! \brief append a task to the run queue, interrupts should be masked
+ *! \param ptThis task object
+ *! \return none
+ */
+static void push_ready(CLASS(task_t) *ptThis)
+{
+    this.ptNext = NULL;
+    if (NULL == s_ptReadyTail) {
+        s_ptReadyHead = ptThis;
+    } else {
+        s_ptReadyTail->ptNext = ptThis;
+    }
+    s_ptReadyTail = ptThis;
+    s_hwReadyCount++;
+    this.chStatus |= TASK_STATUS_QUEUED;
+}
+
+/*! \brief take the first task from the run queue
+ *! \return the task, NULL for none
+ */
+static CLASS(task_t) *pop_ready(void)
+{
+    CLASS(task_t) *ptThis = NULL;
+
+    SAFE_ATOM_CODE(
+        ptThis = s_ptReadyHead;
+        if (NULL != ptThis) {
+            s_ptReadyHead = this.ptNext;
+            if (NULL == s_ptReadyHead) {
+                s_ptReadyTail = NULL;
+            }
+            s_hwReadyCount--;
+            this.ptNext = NULL;
+            this.chStatus &= ~TASK_STATUS_QUEUED;
+            this.chStatus |= TASK_STATUS_RUNNING;
+        }
+    )
+
+    return ptThis;
+}
+
+static fsm_rt_t task_wake_handler(void *pArg, void *pParam)
+{
+    task_wake((task_t *)pArg);
+
+    //! stay subscribed for the next invocation
+    return fsm_rt_cpl;
+}
+
+/*! \brief initialize a task, it wakes only by task_wake() until a wake 
+ *!        condition is added
+ *! \param ptTask task object
+ *! \param fnRoutine task routine
+ *! \param pArg argument passed to fnRoutine
+ *! \return the task object, NULL for invalid parameter
+ */
+task_t *task_init(task_t *ptTask, task_routine_t *fnRoutine, void *pArg)
+{
+    CLASS(task_t) *ptThis = (CLASS(task_t) *)ptTask;
+    if (NULL == ptTask || NULL == fnRoutine) {
+        return NULL;
+    }
+
+    this.fnRoutine = fnRoutine;
+    this.pArg = pArg;
+    this.ptNext = NULL;
+    this.fnCondition = NULL;
+    this.pTarget = NULL;
+    this.wPeriod = 0;
+    this.wDeadline = 0;
+    this.ptEvent = NULL;
+    this.chStatus = 0;
+    delegate_handler_init(&this.tWakeHandler, &task_wake_handler, ptTask);
+
+    return ptTask;
+}
+
+/*! \brief wake the task when a condition is true, e.g. a queue is not empty.
+ *!        Conditions are polled by scheduler_run(), a change made by an ISR
+ *!        right before the cpu sleeps is seen after the next interrupt, e.g.
+ *!        the tick. Call task_wake() in the ISR when it matters.
+ *! \param ptTask task object, it should not be registered yet
+ *! \param fnCondition condition routine
+ *! \param pTarget object passed to fnCondition
+ *! \retval true the condition is set
+ *! \retval false invalid parameter or the task is registered
+ */
+bool task_wake_on_condition(
+    task_t *ptTask, task_condition_t *fnCondition, void *pTarget)
+{
+    CLASS(task_t) *ptThis = (CLASS(task_t) *)ptTask;
+    if (NULL == ptTask || (this.chStatus & TASK_STATUS_REGISTERED)) {
+        return false;
+    }
+
+    this.fnCondition = fnCondition;
+    this.pTarget = pTarget;
+
+    return true;
+}
+
+/*! \brief wake the task every time a delegate is invoked
+ *! \param ptTask task object
+ *! \param ptEvent the delegate
+ *! \retval true the task is subscribed
+ *! \retval false invalid parameter or it is subscribed already
+ */
+bool task_wake_on_delegate(task_t *ptTask, DELEGATE *ptEvent)
+{
+    CLASS(task_t) *ptThis = (CLASS(task_t) *)ptTask;
+    if (NULL == ptTask || NULL == ptEvent || NULL != this.ptEvent) {
+        return false;
+    } else if (GSF_ERR_NONE != register_delegate_handler(
+                                    ptEvent, &this.tWakeHandler)) {
+        return false;
+    }
+    this.ptEvent = ptEvent;
+
+    return true;
+}
+
+/*! \brief wake the task periodically
+ *! \param ptTask task object, it should not be registered yet
+ *! \param wTicks period in timer_wheel_tick() ticks, 0 for none
+ *! \retval true the period is set
+ *! \retval false invalid parameter or the task is registered
+ */
+bool task_wake_every(task_t *ptTask, uint32_t wTicks)
+{
+    CLASS(task_t) *ptThis = (CLASS(task_t) *)ptTask;
+    if (NULL == ptTask || (this.chStatus & TASK_STATUS_REGISTERED)) {
+        return false;
+    }
+
+    this.wPeriod = wTicks;
+
+    return true;
+}
+
+/*! \brief make a task runnable, it could be called in an ISR
+ *! \param ptTask task object
+ *! \return none
+ */
+void task_wake(task_t *ptTask)
+{
+    CLASS(task_t) *ptThis = (CLASS(task_t) *)ptTask;
+    if (NULL == ptTask) {
+        return ;
+    }
+
+    SAFE_ATOM_CODE(
+        if (!(this.chStatus & TASK_STATUS_REGISTERED)) {
+            //! not in the scheduler
+        } else if (this.chStatus & (TASK_STATUS_RUNNING | TASK_STATUS_WATCHED)) {
+            //! the scheduler moves it when the routine returns or in its scan
+            this.chStatus |= TASK_STATUS_WOKEN;
+            s_bWoken = true;
+        } else if (!(this.chStatus & TASK_STATUS_QUEUED)) {
+            push_ready(ptThis);
+        }
+    )
+}
+
+/*! \brief initialize the scheduler
+ *! \return none
+ */
+void scheduler_init(void)
+{
+    SAFE_ATOM_CODE(
+        s_ptReadyHead = NULL;
+        s_ptReadyTail = NULL;
+        s_hwReadyCount = 0;
+        s_ptWatchList = NULL;
+        s_bWoken = false;
+    )
+}
+
+/*! \brief add a task to the scheduler, it is runnable at once
+ *! \param ptTask task object
+ *! \retval true the task is added
+ *! \retval false invalid parameter or it is added already
+ */
+bool scheduler_register(task_t *ptTask)
+{
+    CLASS(task_t) *ptThis = (CLASS(task_t) *)ptTask;
+    if (NULL == ptTask || NULL == this.fnRoutine 
+    ||  (this.chStatus & TASK_STATUS_REGISTERED)) {
+        return false;
+    }
+
+    //! the periods are counted by the tick of the timer wheel
+    this.wDeadline = timer_wheel_get_tick() + this.wPeriod;
+    SAFE_ATOM_CODE(
+        this.chStatus = TASK_STATUS_REGISTERED;
+        push_ready(ptThis);
+    )
+
+    return true;
+}
+
+/*! \brief move the watched tasks which should run to the run queue
+ *! \return none
+ */
+static void scan_watch_list(void)
+{
+    CLASS(task_t) **pptTask = &s_ptWatchList;
+    uint32_t wNow = timer_wheel_get_tick();
+
+    s_bWoken = false;
+    while (NULL != (*pptTask)) {
+        CLASS(task_t) *ptThis = (*pptTask);
+        bool bWake = false;
+
+        if (this.chStatus & TASK_STATUS_WOKEN) {
+            bWake = true;
+        } else if ((NULL != this.fnCondition) && this.fnCondition(this.pTarget)) {
+            bWake = true;
+        } else if ((0 != this.wPeriod) && ((int32_t)(wNow - this.wDeadline) >= 0)) {
+            this.wDeadline += this.wPeriod;
+            if ((int32_t)(wNow - this.wDeadline) >= 0) {
+                //! too late, skip the missed periods
+                this.wDeadline = wNow + this.wPeriod;
+            }
+            bWake = true;
+        }
+
+        if (!bWake) {
+            pptTask = &(this.ptNext);
+            continue;
+        }
+
+        (*pptTask) = this.ptNext;
+        SAFE_ATOM_CODE(
+            this.chStatus &= ~(TASK_STATUS_WATCHED | TASK_STATUS_WOKEN);
+            push_ready(ptThis);
+        )
+    }
+}
+
+/*! \brief run every runnable task once
+ *! \retval fsm_rt_on_going some tasks are still runnable
+ *! \retval fsm_rt_cpl everything is idle, the cpu could sleep until the 
+ *!         next interrupt
+ */
+fsm_rt_t scheduler_run(void)
+{
+    uint_fast16_t hwCount;
+    bool bIdle;
+
+    scan_watch_list();
+
+    //! the tasks woken during this round run in the next one
+    SAFE_ATOM_CODE(
+        hwCount = s_hwReadyCount;
+    )
+    while (hwCount--) {
+        CLASS(task_t) *ptThis = pop_ready();
+        fsm_rt_t tFSM;
+        if (NULL == ptThis) {
+            break;
+        }
+
+        tFSM = this.fnRoutine(this.pArg);
+
+        if (fsm_rt_err == tFSM) {
+            SAFE_ATOM_CODE(
+                this.chStatus = 0;
+            )
+            if (NULL != this.ptEvent) {
+                unregister_delegate_handler(this.ptEvent, &this.tWakeHandler);
+                this.ptEvent = NULL;
+            }
+            continue;
+        }
+
+        SAFE_ATOM_CODE(
+            this.chStatus &= ~TASK_STATUS_RUNNING;
+            if ((fsm_rt_on_going == tFSM) || (this.chStatus & TASK_STATUS_WOKEN)) {
+                this.chStatus &= ~TASK_STATUS_WOKEN;
+                push_ready(ptThis);
+            } else if ((NULL != this.fnCondition) || (0 != this.wPeriod)) {
+                this.ptNext = s_ptWatchList;
+                s_ptWatchList = ptThis;
+                this.chStatus |= TASK_STATUS_WATCHED;
+            }
+        )
+    }
+
+    SAFE_ATOM_CODE(
+        bIdle = (NULL == s_ptReadyHead) && !s_bWoken;
+    )
+    if (bIdle) {
+        //! the conditions could be made true by this round, check them again
+        //! before the cpu sleeps
+        scan_watch_list();
+        SAFE_ATOM_CODE(
+            bIdle = (NULL == s_ptReadyHead) && !s_bWoken;
+        )
+    }
+
+    return bIdle ? fsm_rt_cpl : fsm_rt_on_going;
+}
+
+/*! \brief get the ticks before the nearest periodic wake up or software
+ *!        timer expiry, e.g. to sleep
+ *! \return the ticks, 0xFFFFFFFF for neither periodic task nor running timer
+ */
+uint32_t scheduler_get_idle_ticks(void)
+{
+    CLASS(task_t) *ptThis = s_ptWatchList;
+    uint32_t wNow = timer_wheel_get_tick();
+    uint32_t wTicks = timer_wheel_get_next_expiry();
+
+    for (; NULL != ptThis; ptThis = this.ptNext) {
+        int32_t nLeft;
+        if (0 == this.wPeriod) {
+            continue;
+        }
+        nLeft = (int32_t)(this.wDeadline - wNow);
+        wTicks = MIN(wTicks, (uint32_t)MAX(nLeft, 0));
+    }
+
+    return wTicks;
+}
+
+/* EOF */
@@ -0,0 +1,134 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __UTILITIES_SCHEDULER_H__
+#define __UTILITIES_SCHEDULER_H__
+
+/*============================ INCLUDES ======================================*/
+/*============================ MACROS ========================================*/
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+
+/*! \brief task routine, it is called while the task is runnable
+ *! \param pArg task argument
+ *! \retval fsm_rt_on_going the task stays runnable
+ *! \retval fsm_rt_cpl the task waits for its wake condition
+ *! \retval fsm_rt_err the task is removed from the scheduler
+ */
+typedef fsm_rt_t task_routine_t(void *pArg);
+
+/*! \brief wake condition polled by the scheduler, it should be cheap, e.g.
+ *!        checking whether a queue is not empty
+ *! \param pTarget the object to check
+ *! \retval true the task should run
+ *! \retval false keep waiting
+ */
+typedef bool task_condition_t(void *pTarget);
+
+//! \name cooperative task
+//! @{
+EXTERN_CLASS(task_t)
+    task_routine_t          *fnRoutine;
+    void                    *pArg;
+    task_t                  *ptNext;
+    task_condition_t        *fnCondition;
+    void                    *pTarget;
+    uint32_t                wPeriod;
+    uint32_t                wDeadline;
+    DELEGATE_HANDLE         tWakeHandler;
+    DELEGATE                *ptEvent;
+    uint8_t                 chStatus;
+END_EXTERN_CLASS(task_t)
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+/*! \brief initialize a task, it wakes only by task_wake() until a wake 
+ *!        condition is added
+ *! \param ptTask task object
+ *! \param fnRoutine task routine
+ *! \param pArg argument passed to fnRoutine
+ *! \return the task object, NULL for invalid parameter
+ */
+extern task_t *task_init(task_t *ptTask, task_routine_t *fnRoutine, void *pArg);
+
+/*! \brief wake the task when a condition is true, e.g. a queue is not empty.
+ *!        Conditions are polled by scheduler_run(), a change made by an ISR
+ *!        right before the cpu sleeps is seen after the next interrupt, e.g.
+ *!        the tick. Call task_wake() in the ISR when it matters.
+ *! \param ptTask task object, it should not be registered yet
+ *! \param fnCondition condition routine
+ *! \param pTarget object passed to fnCondition
+ *! \retval true the condition is set
+ *! \retval false invalid parameter or the task is registered
+ */
+extern bool task_wake_on_condition(
+    task_t *ptTask, task_condition_t *fnCondition, void *pTarget);
+
+/*! \brief wake the task every time a delegate is invoked
+ *! \param ptTask task object
+ *! \param ptEvent the delegate
+ *! \retval true the task is subscribed
+ *! \retval false invalid parameter or it is subscribed already
+ */
+extern bool task_wake_on_delegate(task_t *ptTask, DELEGATE *ptEvent);
+
+/*! \brief wake the task periodically
+ *! \param ptTask task object, it should not be registered yet
+ *! \param wTicks period in timer_wheel_tick() ticks, 0 for none
+ *! \retval true the period is set
+ *! \retval false invalid parameter or the task is registered
+ */
+extern bool task_wake_every(task_t *ptTask, uint32_t wTicks);
+
+/*! \brief make a task runnable, it could be called in an ISR
+ *! \param ptTask task object
+ *! \return none
+ */
+extern void task_wake(task_t *ptTask);
+
+/*! \brief initialize the scheduler
+ *! \return none
+ */
+extern void scheduler_init(void);
+
+/*! \brief add a task to the scheduler, it is runnable at once
+ *! \param ptTask task object
+ *! \retval true the task is added
+ *! \retval false invalid parameter or it is added already
+ */
+extern bool scheduler_register(task_t *ptTask);
+
+/*! \brief run every runnable task once
+ *! \retval fsm_rt_on_going some tasks are still runnable
+ *! \retval fsm_rt_cpl everything is idle, the cpu could sleep until the 
+ *!         next interrupt
+ */
+extern fsm_rt_t scheduler_run(void);
+
+/*! \brief get the ticks before the nearest periodic wake up or software
+ *!        timer expiry, e.g. to sleep
+ *! \return the ticks, 0xFFFFFFFF for neither periodic task nor running timer
+ */
+extern uint32_t scheduler_get_idle_ticks(void);
+
+#endif
+/* EOF */
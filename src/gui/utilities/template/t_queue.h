@@ -21,6 +21,8 @@
 #define _USE_TEMPLATE_QUEUE_H_
 
 /*============================ INCLUDES ======================================*/
+#include <string.h>
+
 /*============================ MACROS ========================================*/
 
 #define END_DEF_QUEUE
@@ -33,6 +35,74 @@
 #define END_DEF_SAFE_QUEUE_U16
 #define END_DEF_SAFE_QUEUE_U32
 
+#define END_DEF_SPSC_QUEUE
+#define END_DEF_SPSC_QUEUE_U8
+#define END_DEF_SPSC_QUEUE_U16
+#define END_DEF_SPSC_QUEUE_U32
+
+#define END_DEF_MPMC_QUEUE
+#define END_DEF_MPMC_QUEUE_U8
+#define END_DEF_MPMC_QUEUE_U16
+#define END_DEF_MPMC_QUEUE_U32
+
+#define END_DEF_POW2_QUEUE
+#define END_DEF_POW2_QUEUE_U8
+#define END_DEF_POW2_QUEUE_U16
+#define END_DEF_POW2_QUEUE_U32
+
+#define END_DEF_SAFE_POW2_QUEUE
+#define END_DEF_SAFE_POW2_QUEUE_U8
+#define END_DEF_SAFE_POW2_QUEUE_U16
+#define END_DEF_SAFE_POW2_QUEUE_U32
+
+//! \brief queue statistics of DEF_QUEUE_EX, costs a few bytes per queue
+#ifndef USE_QUEUE_STATISTICS
+#   define USE_QUEUE_STATISTICS     DISABLED
+#endif
+
+#if USE_QUEUE_STATISTICS == ENABLED
+#define __QUEUE_STAT_FIELD          queue_stat_t    tStat;
+#define __QUEUE_STAT_RESET(__Q)                                             \
+            memset(&((__Q)->tStat), 0, sizeof(queue_stat_t))
+#define __QUEUE_STAT_UPDATE(__Q, __ADDED, __DROPPED)                        \
+            do {                                                            \
+                (__Q)->tStat.wEnqueued += (__ADDED);                        \
+                (__Q)->tStat.wDropped += (__DROPPED);                       \
+                if ((__Q)->tCounter > (__Q)->tStat.wPeak) {                 \
+                    (__Q)->tStat.wPeak = (__Q)->tCounter;                   \
+                }                                                           \
+            } while (false)
+
+#define __QUEUE_STAT_PROTOTYPE(__NAME)                                      \
+extern bool __NAME##_queue_stat(                                            \
+    __NAME##_queue_t *ptQueue, queue_stat_t *ptStat, bool bReset);
+
+#define __QUEUE_STAT_IMPLEMENT(__NAME, __ATOM_ACCESS)                       \
+bool __NAME##_queue_stat(                                                   \
+    __NAME##_queue_t *ptQueue, queue_stat_t *ptStat, bool bReset)           \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ || NULL == ptStat) {                                    \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        *ptStat = ptQ->tStat;                                               \
+        if (bReset) {                                                       \
+            __QUEUE_STAT_RESET(ptQ);                                        \
+        }                                                                   \
+    )                                                                       \
+                                                                            \
+    return true;                                                            \
+}
+#else
+#define __QUEUE_STAT_FIELD
+#define __QUEUE_STAT_RESET(__Q)
+#define __QUEUE_STAT_UPDATE(__Q, __ADDED, __DROPPED)
+#define __QUEUE_STAT_PROTOTYPE(__NAME)
+#define __QUEUE_STAT_IMPLEMENT(__NAME, __ATOM_ACCESS)
+#endif
+
 /*============================ MACROFIED FUNCTIONS ===========================*/
 #define NONE_ATOM_ACCESS(...)        {__VA_ARGS__;}
 
@@ -54,6 +124,34 @@
 #define GET_QUEUE_COUNT(__NAME, __QUEUE)                                    \
             __NAME##_get_queue_item_count((__QUEUE))
 
+#define ENQUEUE_N(__NAME, __QUEUE, __BUFFER, __COUNT)                       \
+            __NAME##_enqueue_n((__QUEUE), (__BUFFER), (__COUNT))
+
+#define DEQUEUE_N(__NAME, __QUEUE, __BUFFER, __COUNT)                       \
+            __NAME##_dequeue_n((__QUEUE), (__BUFFER), (__COUNT))
+
+/*! \note a span is the largest part of the buffer that can be accessed 
+ *!       linearly, e.g. by DMA, the access is finished by a commit. The 
+ *!       producer and the consumer should be single.
+ */
+#define PEEK_QUEUE_WRITE_SPAN(__NAME, __QUEUE, __SIZE_ADDR)                 \
+            __NAME##_queue_write_span((__QUEUE), (__SIZE_ADDR))
+
+#define COMMIT_QUEUE_WRITE(__NAME, __QUEUE, __COUNT)                        \
+            __NAME##_queue_write_commit((__QUEUE), (__COUNT))
+
+#define PEEK_QUEUE_READ_SPAN(__NAME, __QUEUE, __SIZE_ADDR)                  \
+            __NAME##_queue_read_span((__QUEUE), (__SIZE_ADDR))
+
+#define COMMIT_QUEUE_READ(__NAME, __QUEUE, __COUNT)                         \
+            __NAME##_queue_read_commit((__QUEUE), (__COUNT))
+
+/*! \note copy the statistics of a queue from DEF_QUEUE_EX while it is
+ *!       running, only available when USE_QUEUE_STATISTICS is ENABLED
+ */
+#define GET_QUEUE_STAT(__NAME, __QUEUE, __STAT_ADDR, __RESET)               \
+            __NAME##_queue_stat((__QUEUE), (__STAT_ADDR), (__RESET))
+
 #define QUEUE(__NAME)   __NAME##_queue_t
 
 #define EXTERN_QUEUE(__NAME, __TYPE, __PTR_TYPE, __MUTEX_TYPE)              \
@@ -64,6 +162,7 @@ EXTERN_CLASS(__NAME##_queue_t)                                              \
     __PTR_TYPE      tTail;                                                  \
     __PTR_TYPE      tCounter;                                               \
     __MUTEX_TYPE    tMutex;                                                 \
+    __QUEUE_STAT_FIELD                                                      \
 END_EXTERN_CLASS(__NAME##_queue_t)                                          \
                                                                             \
 extern __MUTEX_TYPE *__NAME##_queue_mutex(__NAME##_queue_t *ptQueue);       \
@@ -73,6 +172,19 @@ extern bool __NAME##_enqueue(__NAME##_queue_t *ptQueue, __TYPE tObj);       \
 extern bool __NAME##_queue_peek(__NAME##_queue_t *ptQueue, __TYPE *ptObj);  \
 extern bool __NAME##_dequeue(__NAME##_queue_t *ptQueue, __TYPE *ptObj);     \
 extern __PTR_TYPE __NAME##_get_queue_item_count(__NAME##_queue_t *ptQueue); \
+__QUEUE_STAT_PROTOTYPE(__NAME)                                              \
+extern __PTR_TYPE __NAME##_enqueue_n(                                       \
+    __NAME##_queue_t *ptQueue, const __TYPE *ptObj, __PTR_TYPE tCount);     \
+extern __PTR_TYPE __NAME##_dequeue_n(                                       \
+    __NAME##_queue_t *ptQueue, __TYPE *ptObj, __PTR_TYPE tCount);           \
+extern __TYPE *__NAME##_queue_write_span(                                   \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize);                         \
+extern bool __NAME##_queue_write_commit(                                    \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount);                          \
+extern __TYPE *__NAME##_queue_read_span(                                    \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize);                         \
+extern bool __NAME##_queue_read_commit(                                     \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount);
 
 
 #define DEF_QUEUE_EX(                                                       \
@@ -84,6 +196,7 @@ DEF_CLASS(__NAME##_queue_t)                                                 \
     __PTR_TYPE      tTail;                                                  \
     __PTR_TYPE      tCounter;                                               \
     __MUTEX_TYPE    tMutex;                                                 \
+    __QUEUE_STAT_FIELD                                                      \
 END_DEF_CLASS(__NAME##_queue_t)                                             \
                                                                             \
 __MUTEX_TYPE *__NAME##_queue_mutex(__NAME##_queue_t *ptQueue)               \
@@ -108,6 +221,7 @@ bool __NAME##_queue_init(                                                   \
     ptQ->tHead = 0;                                                         \
     ptQ->tTail = 0;                                                         \
     ptQ->tCounter = 0;                                                      \
+    __QUEUE_STAT_RESET(ptQ);                                                \
                                                                             \
     return true;                                                            \
 }                                                                           \
@@ -123,6 +237,7 @@ bool __NAME##_enqueue(__NAME##_queue_t *ptQueue, __TYPE tObj)               \
     __ATOM_ACCESS(                                                          \
         do {                                                                \
             if ((ptQ->tHead == ptQ->tTail) && (0 != ptQ->tCounter)) {       \
+                __QUEUE_STAT_UPDATE(ptQ, 0, 1);                             \
                 break;                                                      \
             }                                                               \
                                                                             \
@@ -131,6 +246,7 @@ bool __NAME##_enqueue(__NAME##_queue_t *ptQueue, __TYPE tObj)               \
                 ptQ->tTail = 0;                                             \
             }                                                               \
             ptQ->tCounter++;                                                \
+            __QUEUE_STAT_UPDATE(ptQ, 1, 0);                                 \
             bResult = true;                                                 \
         } while (false);                                                    \
     )                                                                       \
@@ -199,7 +315,158 @@ __PTR_TYPE __NAME##_get_queue_item_count(__NAME##_queue_t *ptQueue)         \
         tCount = ptQ->tCounter;                                             \
     )                                                                       \
     return tCount;                                                          \
-}
+}                                                                           \
+                                                                            \
+__PTR_TYPE __NAME##_enqueue_n(                                              \
+    __NAME##_queue_t *ptQueue, const __TYPE *ptObj, __PTR_TYPE tCount)      \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ || NULL == ptObj) {                                     \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    /*! one section for the whole block, two copies at most */              \
+    __ATOM_ACCESS(                                                          \
+        __PTR_TYPE tFirst;                                                  \
+        __PTR_TYPE tFree = ptQ->tSize - ptQ->tCounter;                      \
+        if (tCount > tFree) {                                               \
+            __QUEUE_STAT_UPDATE(ptQ, 0, tCount - tFree);                    \
+            tCount = tFree;                                                 \
+        }                                                                   \
+        tFirst = MIN(tCount, ptQ->tSize - ptQ->tTail);                      \
+        memcpy(&ptQ->ptBuffer[ptQ->tTail], ptObj, tFirst * sizeof(__TYPE)); \
+        memcpy( ptQ->ptBuffer, &ptObj[tFirst],                              \
+                (tCount - tFirst) * sizeof(__TYPE));                        \
+        ptQ->tTail += tCount;                                               \
+        if (ptQ->tTail >= ptQ->tSize) {                                     \
+            ptQ->tTail -= ptQ->tSize;                                       \
+        }                                                                   \
+        ptQ->tCounter += tCount;                                            \
+        __QUEUE_STAT_UPDATE(ptQ, tCount, 0);                                \
+    )                                                                       \
+                                                                            \
+    return tCount;                                                          \
+}                                                                           \
+                                                                            \
+__PTR_TYPE __NAME##_dequeue_n(                                              \
+    __NAME##_queue_t *ptQueue, __TYPE *ptObj, __PTR_TYPE tCount)            \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ || NULL == ptObj) {                                     \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        __PTR_TYPE tFirst;                                                  \
+        tCount = MIN(tCount, ptQ->tCounter);                                \
+        tFirst = MIN(tCount, ptQ->tSize - ptQ->tHead);                      \
+        memcpy(ptObj, &ptQ->ptBuffer[ptQ->tHead], tFirst * sizeof(__TYPE)); \
+        memcpy( &ptObj[tFirst], ptQ->ptBuffer,                              \
+                (tCount - tFirst) * sizeof(__TYPE));                        \
+        ptQ->tHead += tCount;                                               \
+        if (ptQ->tHead >= ptQ->tSize) {                                     \
+            ptQ->tHead -= ptQ->tSize;                                       \
+        }                                                                   \
+        ptQ->tCounter -= tCount;                                            \
+    )                                                                       \
+                                                                            \
+    return tCount;                                                          \
+}                                                                           \
+                                                                            \
+__TYPE *__NAME##_queue_write_span(                                          \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize)                          \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tSize = 0;                                                   \
+    if (NULL == ptQ || NULL == ptSize) {                                    \
+        return NULL;                                                        \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        if (ptQ->tCounter < ptQ->tSize) {                                   \
+            if (ptQ->tTail >= ptQ->tHead) {                                 \
+                tSize = ptQ->tSize - ptQ->tTail;                            \
+            } else {                                                        \
+                tSize = ptQ->tHead - ptQ->tTail;                            \
+            }                                                               \
+        }                                                                   \
+    )                                                                       \
+    *ptSize = tSize;                                                        \
+                                                                            \
+    return &ptQ->ptBuffer[ptQ->tTail];                                      \
+}                                                                           \
+                                                                            \
+bool __NAME##_queue_write_commit(                                           \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount)                           \
+{                                                                           \
+    bool bResult = false;                                                   \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        if (tCount <= ptQ->tSize - ptQ->tCounter) {                         \
+            ptQ->tTail += tCount;                                           \
+            if (ptQ->tTail >= ptQ->tSize) {                                 \
+                ptQ->tTail -= ptQ->tSize;                                   \
+            }                                                               \
+            ptQ->tCounter += tCount;                                        \
+            __QUEUE_STAT_UPDATE(ptQ, tCount, 0);                            \
+            bResult = true;                                                 \
+        }                                                                   \
+    )                                                                       \
+                                                                            \
+    return bResult;                                                         \
+}                                                                           \
+                                                                            \
+__TYPE *__NAME##_queue_read_span(                                           \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize)                          \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tSize = 0;                                                   \
+    if (NULL == ptQ || NULL == ptSize) {                                    \
+        return NULL;                                                        \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        if (0 != ptQ->tCounter) {                                           \
+            if (ptQ->tHead < ptQ->tTail) {                                  \
+                tSize = ptQ->tTail - ptQ->tHead;                            \
+            } else {                                                        \
+                tSize = ptQ->tSize - ptQ->tHead;                            \
+            }                                                               \
+        }                                                                   \
+    )                                                                       \
+    *ptSize = tSize;                                                        \
+                                                                            \
+    return &ptQ->ptBuffer[ptQ->tHead];                                      \
+}                                                                           \
+                                                                            \
+bool __NAME##_queue_read_commit(                                            \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount)                           \
+{                                                                           \
+    bool bResult = false;                                                   \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        if (tCount <= ptQ->tCounter) {                                      \
+            ptQ->tHead += tCount;                                           \
+            if (ptQ->tHead >= ptQ->tSize) {                                 \
+                ptQ->tHead -= ptQ->tSize;                                   \
+            }                                                               \
+            ptQ->tCounter -= tCount;                                        \
+            bResult = true;                                                 \
+        }                                                                   \
+    )                                                                       \
+                                                                            \
+    return bResult;                                                         \
+}                                                                           \
+                                                                            \
+__QUEUE_STAT_IMPLEMENT(__NAME, __ATOM_ACCESS)
 
 
 #define DEF_SAFE_QUEUE(__NAME, __TYPE, __PTR_TYPE, __MUTEX_TYPE)            \
@@ -236,8 +503,814 @@ __PTR_TYPE __NAME##_get_queue_item_count(__NAME##_queue_t *ptQueue)         \
         EXTERN_QUEUE(__NAME, uint32_t, __PTR_TYPE, __MUTEX_TYPE)
 
 
+/*! \note single producer, single consumer queue, e.g. between an ISR and the
+ *!       main loop. The producer only writes tTail and the consumer only
+ *!       writes tHead, so no interrupt is masked. __PTR_TYPE should be read
+ *!       and written by one instruction, one item of the buffer is never used.
+ *!       It works with QUEUE_INIT, ENQUEUE, DEQUEUE, PEEK_QUEUE and
+ *!       GET_QUEUE_COUNT.
+ */
+#define EXTERN_SPSC_QUEUE(__NAME, __TYPE, __PTR_TYPE)                       \
+EXTERN_CLASS(__NAME##_queue_t)                                              \
+    __TYPE              *ptBuffer;                                          \
+    __PTR_TYPE          tSize;                                              \
+    volatile __PTR_TYPE tHead;                                              \
+    volatile __PTR_TYPE tTail;                                              \
+END_EXTERN_CLASS(__NAME##_queue_t)                                          \
+                                                                            \
+extern bool __NAME##_queue_init(                                            \
+    __NAME##_queue_t *ptQueue, __TYPE *ptBuffer, __PTR_TYPE tSize);         \
+extern bool __NAME##_enqueue(__NAME##_queue_t *ptQueue, __TYPE tObj);       \
+extern bool __NAME##_queue_peek(__NAME##_queue_t *ptQueue, __TYPE *ptObj);  \
+extern bool __NAME##_dequeue(__NAME##_queue_t *ptQueue, __TYPE *ptObj);     \
+extern __PTR_TYPE __NAME##_get_queue_item_count(__NAME##_queue_t *ptQueue); \
+extern __PTR_TYPE __NAME##_enqueue_n(                                       \
+    __NAME##_queue_t *ptQueue, const __TYPE *ptObj, __PTR_TYPE tCount);     \
+extern __PTR_TYPE __NAME##_dequeue_n(                                       \
+    __NAME##_queue_t *ptQueue, __TYPE *ptObj, __PTR_TYPE tCount);           \
+extern __TYPE *__NAME##_queue_write_span(                                   \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize);                         \
+extern bool __NAME##_queue_write_commit(                                    \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount);                          \
+extern __TYPE *__NAME##_queue_read_span(                                    \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize);                         \
+extern bool __NAME##_queue_read_commit(                                     \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount);
+
+
+#define DEF_SPSC_QUEUE(__NAME, __TYPE, __PTR_TYPE)                          \
+DEF_CLASS(__NAME##_queue_t)                                                 \
+    __TYPE              *ptBuffer;                                          \
+    __PTR_TYPE          tSize;                                              \
+    volatile __PTR_TYPE tHead;                                              \
+    volatile __PTR_TYPE tTail;                                              \
+END_DEF_CLASS(__NAME##_queue_t)                                             \
+                                                                            \
+bool __NAME##_queue_init(                                                   \
+    __NAME##_queue_t *ptQueue, __TYPE *ptBuffer, __PTR_TYPE tSize)          \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQueue || NULL == ptBuffer || tSize < 2) {                 \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    ptQ->ptBuffer = ptBuffer;                                               \
+    ptQ->tSize = tSize;                                                     \
+    ptQ->tHead = 0;                                                         \
+    ptQ->tTail = 0;                                                         \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+bool __NAME##_enqueue(__NAME##_queue_t *ptQueue, __TYPE tObj)               \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tTail, tNext;                                                \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    tTail = ptQ->tTail;                                                     \
+    tNext = tTail + 1;                                                      \
+    if (tNext >= ptQ->tSize) {                                              \
+        tNext = 0;                                                          \
+    }                                                                       \
+    if (tNext == ptQ->tHead) {                                              \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    ptQ->ptBuffer[tTail] = tObj;                                            \
+    /*! the item is written before it is published */                       \
+    MEMORY_BARRIER();                                                       \
+    ptQ->tTail = tNext;                                                     \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+bool __NAME##_queue_peek(__NAME##_queue_t *ptQueue, __TYPE *ptObj)          \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tHead;                                                       \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    tHead = ptQ->tHead;                                                     \
+    if (tHead == ptQ->tTail) {                                              \
+        return false;                                                       \
+    }                                                                       \
+    /*! the item is read after it is published */                           \
+    MEMORY_BARRIER();                                                       \
+    if (NULL != ptObj) {                                                    \
+        *ptObj = ptQ->ptBuffer[tHead];                                      \
+    }                                                                       \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+bool __NAME##_dequeue(__NAME##_queue_t *ptQueue, __TYPE *ptObj)             \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tHead, tNext;                                                \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    tHead = ptQ->tHead;                                                     \
+    if (tHead == ptQ->tTail) {                                              \
+        return false;                                                       \
+    }                                                                       \
+    /*! the item is read after it is published */                           \
+    MEMORY_BARRIER();                                                       \
+    if (NULL != ptObj) {                                                    \
+        *ptObj = ptQ->ptBuffer[tHead];                                      \
+    }                                                                       \
+    tNext = tHead + 1;                                                      \
+    if (tNext >= ptQ->tSize) {                                              \
+        tNext = 0;                                                          \
+    }                                                                       \
+    /*! the item is read before its room is given back */                   \
+    MEMORY_BARRIER();                                                       \
+    ptQ->tHead = tNext;                                                     \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+__PTR_TYPE __NAME##_get_queue_item_count(__NAME##_queue_t *ptQueue)         \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tHead, tTail;                                                \
+    if (NULL == ptQ) {                                                      \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    tHead = ptQ->tHead;                                                     \
+    tTail = ptQ->tTail;                                                     \
+    if (tTail >= tHead) {                                                   \
+        return tTail - tHead;                                               \
+    }                                                                       \
+    return ptQ->tSize - tHead + tTail;                                      \
+}                                                                           \
+                                                                            \
+__TYPE *__NAME##_queue_write_span(                                          \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize)                          \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tHead, tTail;                                                \
+    if (NULL == ptQ || NULL == ptSize) {                                    \
+        return NULL;                                                        \
+    }                                                                       \
+                                                                            \
+    tHead = ptQ->tHead;                                                     \
+    tTail = ptQ->tTail;                                                     \
+    if (tTail >= tHead) {                                                   \
+        /*! the tail never catches up the head */                           \
+        *ptSize = ptQ->tSize - tTail - (0 == tHead);                        \
+    } else {                                                                \
+        *ptSize = tHead - tTail - 1;                                        \
+    }                                                                       \
+    /*! the room is written after it is given back */                       \
+    MEMORY_BARRIER();                                                       \
+                                                                            \
+    return &ptQ->ptBuffer[tTail];                                           \
+}                                                                           \
+                                                                            \
+bool __NAME##_queue_write_commit(                                           \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount)                           \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tSize;                                                       \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __NAME##_queue_write_span(ptQueue, &tSize);                             \
+    if (tCount > tSize) {                                                   \
+        return false;                                                       \
+    }                                                                       \
+    tSize = ptQ->tTail + tCount;                                            \
+    if (tSize >= ptQ->tSize) {                                              \
+        tSize = 0;                                                          \
+    }                                                                       \
+    /*! the items are written before they are published */                  \
+    MEMORY_BARRIER();                                                       \
+    ptQ->tTail = tSize;                                                     \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+__TYPE *__NAME##_queue_read_span(                                           \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize)                          \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tHead, tTail;                                                \
+    if (NULL == ptQ || NULL == ptSize) {                                    \
+        return NULL;                                                        \
+    }                                                                       \
+                                                                            \
+    tHead = ptQ->tHead;                                                     \
+    tTail = ptQ->tTail;                                                     \
+    if (tTail >= tHead) {                                                   \
+        *ptSize = tTail - tHead;                                            \
+    } else {                                                                \
+        *ptSize = ptQ->tSize - tHead;                                       \
+    }                                                                       \
+    /*! the items are read after they are published */                      \
+    MEMORY_BARRIER();                                                       \
+                                                                            \
+    return &ptQ->ptBuffer[tHead];                                           \
+}                                                                           \
+                                                                            \
+bool __NAME##_queue_read_commit(                                            \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount)                           \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tSize;                                                       \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __NAME##_queue_read_span(ptQueue, &tSize);                              \
+    if (tCount > tSize) {                                                   \
+        return false;                                                       \
+    }                                                                       \
+    tSize = ptQ->tHead + tCount;                                            \
+    if (tSize >= ptQ->tSize) {                                              \
+        tSize = 0;                                                          \
+    }                                                                       \
+    /*! the items are read before their room is given back */               \
+    MEMORY_BARRIER();                                                       \
+    ptQ->tHead = tSize;                                                     \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+__PTR_TYPE __NAME##_enqueue_n(                                              \
+    __NAME##_queue_t *ptQueue, const __TYPE *ptObj, __PTR_TYPE tCount)      \
+{                                                                           \
+    __PTR_TYPE tWritten = 0;                                                \
+    if (NULL == ptObj) {                                                    \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    /*! the end of the buffer and then the beginning */                     \
+    while (tWritten < tCount) {                                             \
+        __PTR_TYPE tSize;                                                   \
+        __TYPE *ptSpan = __NAME##_queue_write_span(ptQueue, &tSize);        \
+        if (NULL == ptSpan || 0 == tSize) {                                 \
+            break;                                                          \
+        }                                                                   \
+        tSize = MIN(tSize, tCount - tWritten);                              \
+        memcpy(ptSpan, &ptObj[tWritten], tSize * sizeof(__TYPE));           \
+        __NAME##_queue_write_commit(ptQueue, tSize);                        \
+        tWritten += tSize;                                                  \
+    }                                                                       \
+                                                                            \
+    return tWritten;                                                        \
+}                                                                           \
+                                                                            \
+__PTR_TYPE __NAME##_dequeue_n(                                              \
+    __NAME##_queue_t *ptQueue, __TYPE *ptObj, __PTR_TYPE tCount)            \
+{                                                                           \
+    __PTR_TYPE tRead = 0;                                                   \
+    if (NULL == ptObj) {                                                    \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    while (tRead < tCount) {                                                \
+        __PTR_TYPE tSize;                                                   \
+        __TYPE *ptSpan = __NAME##_queue_read_span(ptQueue, &tSize);         \
+        if (NULL == ptSpan || 0 == tSize) {                                 \
+            break;                                                          \
+        }                                                                   \
+        tSize = MIN(tSize, tCount - tRead);                                 \
+        memcpy(&ptObj[tRead], ptSpan, tSize * sizeof(__TYPE));              \
+        __NAME##_queue_read_commit(ptQueue, tSize);                         \
+        tRead += tSize;                                                     \
+    }                                                                       \
+                                                                            \
+    return tRead;                                                           \
+}
+
+#define DEF_SPSC_QUEUE_U8(__NAME, __PTR_TYPE)                               \
+        DEF_SPSC_QUEUE(__NAME, uint8_t, __PTR_TYPE)
+
+#define DEF_SPSC_QUEUE_U16(__NAME, __PTR_TYPE)                              \
+        DEF_SPSC_QUEUE(__NAME, uint16_t, __PTR_TYPE)
+
+#define DEF_SPSC_QUEUE_U32(__NAME, __PTR_TYPE)                              \
+        DEF_SPSC_QUEUE(__NAME, uint32_t, __PTR_TYPE)
+
+#define EXTERN_SPSC_QUEUE_U8(__NAME, __PTR_TYPE)                            \
+        EXTERN_SPSC_QUEUE(__NAME, uint8_t, __PTR_TYPE)
+
+#define EXTERN_SPSC_QUEUE_U16(__NAME, __PTR_TYPE)                           \
+        EXTERN_SPSC_QUEUE(__NAME, uint16_t, __PTR_TYPE)
+
+#define EXTERN_SPSC_QUEUE_U32(__NAME, __PTR_TYPE)                           \
+        EXTERN_SPSC_QUEUE(__NAME, uint32_t, __PTR_TYPE)
+
+
+//! 8bit cores access the 32bit sequence and indexes byte by byte, an ISR
+//! could see a half written word, so they are copied with interrupts masked
+#if defined(__CPU_AVR__)
+#   define __MPMC_ATOM_COPY(__DST, __SRC)   SAFE_ATOM_CODE((__DST) = (__SRC);)
+#else
+#   define __MPMC_ATOM_COPY(__DST, __SRC)   do { (__DST) = (__SRC); } while (0)
+#endif
+
+/*! \note multiple producer, multiple consumer queue, e.g. several ISRs
+ *!       posting events to the main loop. Every item carries a sequence
+ *!       number and the indexes are claimed by ATOM_CAS_U32, so with
+ *!       exclusive access a producer never blocks an interrupt. The cores
+ *!       without it mask the interrupts for the compare and swap only, and
+ *!       8bit cores also for each access to the 32bit words.
+ *!       The buffer is an array of __NAME##_queue_item_t with a power of
+ *!       two size. It works with QUEUE_INIT, ENQUEUE, DEQUEUE and
+ *!       GET_QUEUE_COUNT, there is no peek or span access because another
+ *!       consumer could take the item in between.
+ */
+#define EXTERN_MPMC_QUEUE(__NAME, __TYPE)                                   \
+typedef struct {                                                            \
+    volatile uint32_t   wSequence;                                          \
+    __TYPE              tObj;                                               \
+} __NAME##_queue_item_t;                                                    \
+                                                                            \
+EXTERN_CLASS(__NAME##_queue_t)                                              \
+    __NAME##_queue_item_t   *ptBuffer;                                      \
+    uint32_t                wMask;                                          \
+    volatile uint32_t       wHead;                                          \
+    volatile uint32_t       wTail;                                          \
+END_EXTERN_CLASS(__NAME##_queue_t)                                          \
+                                                                            \
+extern bool __NAME##_queue_init(                                            \
+    __NAME##_queue_t *ptQueue, __NAME##_queue_item_t *ptBuffer,             \
+    uint32_t wSize);                                                        \
+extern bool __NAME##_enqueue(__NAME##_queue_t *ptQueue, __TYPE tObj);       \
+extern bool __NAME##_dequeue(__NAME##_queue_t *ptQueue, __TYPE *ptObj);     \
+extern uint32_t __NAME##_get_queue_item_count(__NAME##_queue_t *ptQueue);
+
+
+#define DEF_MPMC_QUEUE(__NAME, __TYPE)                                      \
+typedef struct {                                                            \
+    volatile uint32_t   wSequence;                                          \
+    __TYPE              tObj;                                               \
+} __NAME##_queue_item_t;                                                    \
+                                                                            \
+DEF_CLASS(__NAME##_queue_t)                                                 \
+    __NAME##_queue_item_t   *ptBuffer;                                      \
+    uint32_t                wMask;                                          \
+    volatile uint32_t       wHead;                                          \
+    volatile uint32_t       wTail;                                          \
+END_DEF_CLASS(__NAME##_queue_t)                                             \
+                                                                            \
+bool __NAME##_queue_init(                                                   \
+    __NAME##_queue_t *ptQueue, __NAME##_queue_item_t *ptBuffer,             \
+    uint32_t wSize)                                                         \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    uint32_t n;                                                             \
+    if (NULL == ptQueue || NULL == ptBuffer || 0 == wSize) {                \
+        return false;                                                       \
+    } else if (0 != (wSize & (wSize - 1))) {                                \
+        /*! not a power of two */                                           \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    for (n = 0; n < wSize; n++) {                                           \
+        ptBuffer[n].wSequence = n;                                          \
+    }                                                                       \
+    ptQ->ptBuffer = ptBuffer;                                               \
+    ptQ->wMask = wSize - 1;                                                 \
+    ptQ->wHead = 0;                                                         \
+    ptQ->wTail = 0;                                                         \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+bool __NAME##_enqueue(__NAME##_queue_t *ptQueue, __TYPE tObj)               \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __NAME##_queue_item_t *ptItem;                                          \
+    uint32_t wPos;                                                          \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __MPMC_ATOM_COPY(wPos, ptQ->wTail);                                     \
+    do {                                                                    \
+        uint32_t wSequence;                                                 \
+        int32_t nDiff;                                                      \
+        ptItem = &ptQ->ptBuffer[wPos & ptQ->wMask];                         \
+        __MPMC_ATOM_COPY(wSequence, ptItem->wSequence);                     \
+        nDiff = (int32_t)(wSequence - wPos);                                \
+        if (nDiff < 0) {                                                    \
+            /*! the item is not consumed yet, the queue is full */          \
+            return false;                                                   \
+        } else if (0 == nDiff) {                                            \
+            if (ATOM_CAS_U32(&ptQ->wTail, wPos, wPos + 1)) {                \
+                break;                                                      \
+            }                                                               \
+        }                                                                   \
+        /*! someone else claimed the item, try the next one */              \
+        __MPMC_ATOM_COPY(wPos, ptQ->wTail);                                 \
+    } while (true);                                                         \
+                                                                            \
+    MEMORY_BARRIER();                                                       \
+    ptItem->tObj = tObj;                                                    \
+    MEMORY_BARRIER();                                                       \
+    __MPMC_ATOM_COPY(ptItem->wSequence, wPos + 1);                          \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+bool __NAME##_dequeue(__NAME##_queue_t *ptQueue, __TYPE *ptObj)             \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __NAME##_queue_item_t *ptItem;                                          \
+    uint32_t wPos;                                                          \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __MPMC_ATOM_COPY(wPos, ptQ->wHead);                                     \
+    do {                                                                    \
+        uint32_t wSequence;                                                 \
+        int32_t nDiff;                                                      \
+        ptItem = &ptQ->ptBuffer[wPos & ptQ->wMask];                         \
+        __MPMC_ATOM_COPY(wSequence, ptItem->wSequence);                     \
+        nDiff = (int32_t)(wSequence - (wPos + 1));                          \
+        if (nDiff < 0) {                                                    \
+            /*! the item is not published yet, the queue is empty */        \
+            return false;                                                   \
+        } else if (0 == nDiff) {                                            \
+            if (ATOM_CAS_U32(&ptQ->wHead, wPos, wPos + 1)) {                \
+                break;                                                      \
+            }                                                               \
+        }                                                                   \
+        __MPMC_ATOM_COPY(wPos, ptQ->wHead);                                 \
+    } while (true);                                                         \
+                                                                            \
+    MEMORY_BARRIER();                                                       \
+    if (NULL != ptObj) {                                                    \
+        *ptObj = ptItem->tObj;                                              \
+    }                                                                       \
+    MEMORY_BARRIER();                                                       \
+    __MPMC_ATOM_COPY(ptItem->wSequence, wPos + ptQ->wMask + 1);             \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+uint32_t __NAME##_get_queue_item_count(__NAME##_queue_t *ptQueue)           \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    uint32_t wHead, wTail;                                                  \
+    if (NULL == ptQ) {                                                      \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    /*! a snapshot only, read the head first so it never passes the tail */ \
+    __MPMC_ATOM_COPY(wHead, ptQ->wHead);                                    \
+    MEMORY_BARRIER();                                                       \
+    __MPMC_ATOM_COPY(wTail, ptQ->wTail);                                    \
+    return wTail - wHead;                                                   \
+}
+
+#define DEF_MPMC_QUEUE_U8(__NAME)                                           \
+        DEF_MPMC_QUEUE(__NAME, uint8_t)
+
+#define DEF_MPMC_QUEUE_U16(__NAME)                                          \
+        DEF_MPMC_QUEUE(__NAME, uint16_t)
+
+#define DEF_MPMC_QUEUE_U32(__NAME)                                          \
+        DEF_MPMC_QUEUE(__NAME, uint32_t)
+
+#define EXTERN_MPMC_QUEUE_U8(__NAME)                                        \
+        EXTERN_MPMC_QUEUE(__NAME, uint8_t)
+
+#define EXTERN_MPMC_QUEUE_U16(__NAME)                                       \
+        EXTERN_MPMC_QUEUE(__NAME, uint16_t)
+
+#define EXTERN_MPMC_QUEUE_U32(__NAME)                                       \
+        EXTERN_MPMC_QUEUE(__NAME, uint32_t)
+
+
+/*! \note queue with a power of two size. tHead and tTail run freely and
+ *!       are masked when the buffer is accessed, the item count is
+ *!       tTail - tHead, so there is no counter and no wrapping branch.
+ *!       The size is 2^(n-1) at most for an n bit __PTR_TYPE. It has the
+ *!       same interface as the queue from DEF_QUEUE_EX.
+ */
+#define EXTERN_POW2_QUEUE(__NAME, __TYPE, __PTR_TYPE, __MUTEX_TYPE)         \
+EXTERN_CLASS(__NAME##_queue_t)                                              \
+    __TYPE          *ptBuffer;                                              \
+    __PTR_TYPE      tMask;                                                  \
+    __PTR_TYPE      tHead;                                                  \
+    __PTR_TYPE      tTail;                                                  \
+    __MUTEX_TYPE    tMutex;                                                 \
+END_EXTERN_CLASS(__NAME##_queue_t)                                          \
+                                                                            \
+extern __MUTEX_TYPE *__NAME##_queue_mutex(__NAME##_queue_t *ptQueue);       \
+extern bool __NAME##_queue_init(                                            \
+    __NAME##_queue_t *ptQueue, __TYPE *ptBuffer, __PTR_TYPE tSize);         \
+extern bool __NAME##_enqueue(__NAME##_queue_t *ptQueue, __TYPE tObj);       \
+extern bool __NAME##_queue_peek(__NAME##_queue_t *ptQueue, __TYPE *ptObj);  \
+extern bool __NAME##_dequeue(__NAME##_queue_t *ptQueue, __TYPE *ptObj);     \
+extern __PTR_TYPE __NAME##_get_queue_item_count(__NAME##_queue_t *ptQueue); \
+extern __PTR_TYPE __NAME##_enqueue_n(                                       \
+    __NAME##_queue_t *ptQueue, const __TYPE *ptObj, __PTR_TYPE tCount);     \
+extern __PTR_TYPE __NAME##_dequeue_n(                                       \
+    __NAME##_queue_t *ptQueue, __TYPE *ptObj, __PTR_TYPE tCount);           \
+extern __TYPE *__NAME##_queue_write_span(                                   \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize);                         \
+extern bool __NAME##_queue_write_commit(                                    \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount);                          \
+extern __TYPE *__NAME##_queue_read_span(                                    \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize);                         \
+extern bool __NAME##_queue_read_commit(                                     \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount);
+
+
+#define DEF_POW2_QUEUE_EX(                                                  \
+    __NAME, __TYPE, __PTR_TYPE, __MUTEX_TYPE, __ATOM_ACCESS)                \
+DEF_CLASS(__NAME##_queue_t)                                                 \
+    __TYPE          *ptBuffer;                                              \
+    __PTR_TYPE      tMask;                                                  \
+    __PTR_TYPE      tHead;                                                  \
+    __PTR_TYPE      tTail;                                                  \
+    __MUTEX_TYPE    tMutex;                                                 \
+END_DEF_CLASS(__NAME##_queue_t)                                             \
+                                                                            \
+__MUTEX_TYPE *__NAME##_queue_mutex(__NAME##_queue_t *ptQueue)               \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if ( NULL == ptQueue)  {                                                \
+        return NULL;                                                        \
+    }                                                                       \
+    return &(ptQ->tMutex);                                                  \
+}                                                                           \
+                                                                            \
+bool __NAME##_queue_init(                                                   \
+    __NAME##_queue_t *ptQueue, __TYPE *ptBuffer, __PTR_TYPE tSize)          \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQueue || NULL == ptBuffer || 0 == tSize) {                \
+        return false;                                                       \
+    } else if (0 != (tSize & (tSize - 1))) {                                \
+        /*! not a power of two */                                           \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    ptQ->ptBuffer = ptBuffer;                                               \
+    ptQ->tMask = tSize - 1;                                                 \
+    ptQ->tHead = 0;                                                         \
+    ptQ->tTail = 0;                                                         \
+                                                                            \
+    return true;                                                            \
+}                                                                           \
+                                                                            \
+bool __NAME##_enqueue(__NAME##_queue_t *ptQueue, __TYPE tObj)               \
+{                                                                           \
+    bool bResult = false;                                                   \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        if ((__PTR_TYPE)(ptQ->tTail - ptQ->tHead) <= ptQ->tMask) {          \
+            ptQ->ptBuffer[ptQ->tTail++ & ptQ->tMask] = tObj;                \
+            bResult = true;                                                 \
+        }                                                                   \
+    )                                                                       \
+                                                                            \
+    return bResult;                                                         \
+}                                                                           \
+                                                                            \
+bool __NAME##_queue_peek(__NAME##_queue_t *ptQueue, __TYPE *ptObj)          \
+{                                                                           \
+    bool bResult = false;                                                   \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        if (ptQ->tHead != ptQ->tTail) {                                     \
+            if (NULL != ptObj) {                                            \
+                *ptObj = ptQ->ptBuffer[ptQ->tHead & ptQ->tMask];            \
+            }                                                               \
+            bResult = true;                                                 \
+        }                                                                   \
+    )                                                                       \
+                                                                            \
+    return bResult;                                                         \
+}                                                                           \
+                                                                            \
+bool __NAME##_dequeue(__NAME##_queue_t *ptQueue, __TYPE *ptObj)             \
+{                                                                           \
+    bool bResult = false;                                                   \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        if (ptQ->tHead != ptQ->tTail) {                                     \
+            if (NULL != ptObj) {                                            \
+                *ptObj = ptQ->ptBuffer[ptQ->tHead & ptQ->tMask];            \
+            }                                                               \
+            ptQ->tHead++;                                                   \
+            bResult = true;                                                 \
+        }                                                                   \
+    )                                                                       \
+                                                                            \
+    return bResult;                                                         \
+}                                                                           \
+                                                                            \
+__PTR_TYPE __NAME##_get_queue_item_count(__NAME##_queue_t *ptQueue)         \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tCount;                                                      \
+    if (NULL == ptQ) {                                                      \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        tCount = ptQ->tTail - ptQ->tHead;                                   \
+    )                                                                       \
+    return tCount;                                                          \
+}                                                                           \
+                                                                            \
+__PTR_TYPE __NAME##_enqueue_n(                                              \
+    __NAME##_queue_t *ptQueue, const __TYPE *ptObj, __PTR_TYPE tCount)      \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ || NULL == ptObj) {                                     \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        __PTR_TYPE tIndex = ptQ->tTail & ptQ->tMask;                        \
+        __PTR_TYPE tFirst;                                                  \
+        tCount = MIN(   tCount,                                             \
+                        (__PTR_TYPE)(   ptQ->tMask + 1                      \
+                                    -   (ptQ->tTail - ptQ->tHead)));        \
+        tFirst = MIN(tCount, ptQ->tMask + 1 - tIndex);                      \
+        memcpy(&ptQ->ptBuffer[tIndex], ptObj, tFirst * sizeof(__TYPE));     \
+        memcpy( ptQ->ptBuffer, &ptObj[tFirst],                              \
+                (tCount - tFirst) * sizeof(__TYPE));                        \
+        ptQ->tTail += tCount;                                               \
+    )                                                                       \
+                                                                            \
+    return tCount;                                                          \
+}                                                                           \
+                                                                            \
+__PTR_TYPE __NAME##_dequeue_n(                                              \
+    __NAME##_queue_t *ptQueue, __TYPE *ptObj, __PTR_TYPE tCount)            \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ || NULL == ptObj) {                                     \
+        return 0;                                                           \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        __PTR_TYPE tIndex = ptQ->tHead & ptQ->tMask;                        \
+        __PTR_TYPE tFirst;                                                  \
+        tCount = MIN(tCount, (__PTR_TYPE)(ptQ->tTail - ptQ->tHead));        \
+        tFirst = MIN(tCount, ptQ->tMask + 1 - tIndex);                      \
+        memcpy(ptObj, &ptQ->ptBuffer[tIndex], tFirst * sizeof(__TYPE));     \
+        memcpy( &ptObj[tFirst], ptQ->ptBuffer,                              \
+                (tCount - tFirst) * sizeof(__TYPE));                        \
+        ptQ->tHead += tCount;                                               \
+    )                                                                       \
+                                                                            \
+    return tCount;                                                          \
+}                                                                           \
+                                                                            \
+__TYPE *__NAME##_queue_write_span(                                          \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize)                          \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tIndex;                                                      \
+    if (NULL == ptQ || NULL == ptSize) {                                    \
+        return NULL;                                                        \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        tIndex = ptQ->tTail & ptQ->tMask;                                   \
+        *ptSize = MIN(  (__PTR_TYPE)(   ptQ->tMask + 1                      \
+                                    -   (ptQ->tTail - ptQ->tHead)),         \
+                        (__PTR_TYPE)(ptQ->tMask + 1 - tIndex));             \
+    )                                                                       \
+                                                                            \
+    return &ptQ->ptBuffer[tIndex];                                          \
+}                                                                           \
+                                                                            \
+bool __NAME##_queue_write_commit(                                           \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount)                           \
+{                                                                           \
+    bool bResult = false;                                                   \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        if (tCount <= (__PTR_TYPE)(     ptQ->tMask + 1                      \
+                                    -   (ptQ->tTail - ptQ->tHead))) {       \
+            ptQ->tTail += tCount;                                           \
+            bResult = true;                                                 \
+        }                                                                   \
+    )                                                                       \
+                                                                            \
+    return bResult;                                                         \
+}                                                                           \
+                                                                            \
+__TYPE *__NAME##_queue_read_span(                                           \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE *ptSize)                          \
+{                                                                           \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    __PTR_TYPE tIndex;                                                      \
+    if (NULL == ptQ || NULL == ptSize) {                                    \
+        return NULL;                                                        \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        tIndex = ptQ->tHead & ptQ->tMask;                                   \
+        *ptSize = MIN(  (__PTR_TYPE)(ptQ->tTail - ptQ->tHead),              \
+                        (__PTR_TYPE)(ptQ->tMask + 1 - tIndex));             \
+    )                                                                       \
+                                                                            \
+    return &ptQ->ptBuffer[tIndex];                                          \
+}                                                                           \
+                                                                            \
+bool __NAME##_queue_read_commit(                                            \
+    __NAME##_queue_t *ptQueue, __PTR_TYPE tCount)                           \
+{                                                                           \
+    bool bResult = false;                                                   \
+    CLASS(__NAME##_queue_t) *ptQ = (CLASS(__NAME##_queue_t) *)ptQueue;      \
+    if (NULL == ptQ) {                                                      \
+        return false;                                                       \
+    }                                                                       \
+                                                                            \
+    __ATOM_ACCESS(                                                          \
+        if (tCount <= (__PTR_TYPE)(ptQ->tTail - ptQ->tHead)) {              \
+            ptQ->tHead += tCount;                                           \
+            bResult = true;                                                 \
+        }                                                                   \
+    )                                                                       \
+                                                                            \
+    return bResult;                                                         \
+}
+
+#define DEF_SAFE_POW2_QUEUE(__NAME, __TYPE, __PTR_TYPE, __MUTEX_TYPE)       \
+        DEF_POW2_QUEUE_EX(                                                  \
+            __NAME, __TYPE, __PTR_TYPE, __MUTEX_TYPE, SAFE_ATOM_CODE)
+
+#define DEF_SAFE_POW2_QUEUE_U8(__NAME, __PTR_TYPE, __MUTEX_TYPE)            \
+        DEF_SAFE_POW2_QUEUE(__NAME, uint8_t, __PTR_TYPE, __MUTEX_TYPE)
+
+#define DEF_SAFE_POW2_QUEUE_U16(__NAME, __PTR_TYPE, __MUTEX_TYPE)           \
+        DEF_SAFE_POW2_QUEUE(__NAME, uint16_t, __PTR_TYPE, __MUTEX_TYPE)
+
+#define DEF_SAFE_POW2_QUEUE_U32(__NAME, __PTR_TYPE, __MUTEX_TYPE)           \
+        DEF_SAFE_POW2_QUEUE(__NAME, uint32_t, __PTR_TYPE, __MUTEX_TYPE)
+
+#define DEF_POW2_QUEUE(__NAME, __TYPE, __PTR_TYPE, __MUTEX_TYPE)            \
+        DEF_POW2_QUEUE_EX(                                                  \
+            __NAME, __TYPE, __PTR_TYPE, __MUTEX_TYPE, NONE_ATOM_ACCESS)
+
+#define DEF_POW2_QUEUE_U8(__NAME, __PTR_TYPE, __MUTEX_TYPE)                 \
+        DEF_POW2_QUEUE(__NAME, uint8_t, __PTR_TYPE, __MUTEX_TYPE)
+
+#define DEF_POW2_QUEUE_U16(__NAME, __PTR_TYPE, __MUTEX_TYPE)                \
+        DEF_POW2_QUEUE(__NAME, uint16_t, __PTR_TYPE, __MUTEX_TYPE)
+
+#define DEF_POW2_QUEUE_U32(__NAME, __PTR_TYPE, __MUTEX_TYPE)                \
+        DEF_POW2_QUEUE(__NAME, uint32_t, __PTR_TYPE, __MUTEX_TYPE)
+
+#define EXTERN_POW2_QUEUE_U8(__NAME, __PTR_TYPE, __MUTEX_TYPE)              \
+        EXTERN_POW2_QUEUE(__NAME, uint8_t, __PTR_TYPE, __MUTEX_TYPE)
+
+#define EXTERN_POW2_QUEUE_U16(__NAME, __PTR_TYPE, __MUTEX_TYPE)             \
+        EXTERN_POW2_QUEUE(__NAME, uint16_t, __PTR_TYPE, __MUTEX_TYPE)
+
+#define EXTERN_POW2_QUEUE_U32(__NAME, __PTR_TYPE, __MUTEX_TYPE)             \
+        EXTERN_POW2_QUEUE(__NAME, uint32_t, __PTR_TYPE, __MUTEX_TYPE)
+
 
 /*============================ TYPES =========================================*/
+
+//! \name queue statistics
+//! @{
+typedef struct {
+    uint32_t        wEnqueued;      //!< items accepted in total
+    uint32_t        wDropped;       //!< items refused because it was full
+    uint32_t        wPeak;          //!< high-water mark of the item count
+} queue_stat_t;
+//! @}
+
 /*============================ GLOBAL VARIABLES ==============================*/
 /*============================ LOCAL VARIABLES ===============================*/
 /*============================ PROTOTYPES ====================================*/
@@ -0,0 +1,283 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+/*============================ INCLUDES ======================================*/
+#ifndef __STORE_ENVIRONMENT_CFG_IN_PROJ__
+#include "..\..\environment_cfg.h"
+#endif
+
+#include ".\compiler.h"
+#include ".\timer_wheel.h"
+
+/*============================ MACROS ========================================*/
+
+#define this             (*ptThis)
+
+#if (TIMER_WHEEL_SIZE & (TIMER_WHEEL_SIZE - 1)) != 0
+#   error TIMER_WHEEL_SIZE should be a power of two
+#endif
+
+#define TIMER_WHEEL_MASK            (TIMER_WHEEL_SIZE - 1)
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+
+//! \name software timer
+//! @{
+//! \note a running timer is linked in the slot (wExpire & TIMER_WHEEL_MASK),
+//!       pptPrev points to the link pointing to it so it is removed at once
+typedef struct __soft_timer CLASS(soft_timer_t);
+struct __soft_timer {
+    CLASS(soft_timer_t)     *ptNext;        //!< next timer in the same slot
+    CLASS(soft_timer_t)     **pptPrev;      //!< the link pointing to it
+    uint32_t                wExpire;        //!< tick of expiry
+    uint32_t                wPeriod;        //!< reload ticks, 0 for one-shot
+    DELEGATE_HANDLE         *ptHandler;     //!< expiry handler
+};
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+static CLASS(soft_timer_t) *s_ptSlot[TIMER_WHEEL_SIZE];
+static CLASS(soft_timer_t) *s_ptExpired = NULL;     //!< timers being fired
+static volatile uint32_t s_wTick = 0;               //!< tick of the isr
+static uint32_t s_wDone = 0;                        //!< last handled tick
+
+/*============================ PROTOTYPES ====================================*/
+/*============================ IMPLEMENTATION ================================*/
+
+static void timer_link(CLASS(soft_timer_t) **pptList, CLASS(soft_timer_t) *ptThis)
+{
+    this.ptNext = (*pptList);
+    if (NULL != this.ptNext) {
+        this.ptNext->pptPrev = &(this.ptNext);
+    }
+    this.pptPrev = pptList;
+    (*pptList) = ptThis;
+}
+
+static void timer_unlink(CLASS(soft_timer_t) *ptThis)
+{
+    (*this.pptPrev) = this.ptNext;
+    if (NULL != this.ptNext) {
+        this.ptNext->pptPrev = this.pptPrev;
+    }
+    this.ptNext = NULL;
+    this.pptPrev = NULL;
+}
+
+/*! \brief initialize the timer wheel
+ *! \return none
+ */
+void timer_wheel_init(void)
+{
+    uint_fast16_t n;
+    for (n = 0; n < TIMER_WHEEL_SIZE; n++) {
+        s_ptSlot[n] = NULL;
+    }
+    s_ptExpired = NULL;
+    SAFE_ATOM_CODE(
+        s_wTick = 0;
+    )
+    s_wDone = 0;
+}
+
+/*! \brief advance the time of the wheel, call it in the tick interrupt
+ *! \return none
+ */
+void timer_wheel_tick(void)
+{
+    s_wTick++;
+}
+
+/*! \brief get the ticks counted since timer_wheel_init()
+ *! \return the ticks, it wraps around
+ */
+uint32_t timer_wheel_get_tick(void)
+{
+    uint32_t wTick;
+
+    //! the word is not read at once by 8bit cores
+    SAFE_ATOM_CODE(
+        wTick = s_wTick;
+    )
+
+    return wTick;
+}
+
+/*! \brief fire the expired timers, call it in the main loop or a task
+ *! \return fsm_rt_cpl all elapsed ticks are handled
+ */
+fsm_rt_t timer_wheel_run(void)
+{
+    uint32_t wNow = timer_wheel_get_tick();
+
+    while (s_wDone != wNow) {
+        CLASS(soft_timer_t) **pptTimer;
+        s_wDone++;
+
+        //! move the expired timers out first, a handler could cancel any timer
+        pptTimer = &s_ptSlot[s_wDone & TIMER_WHEEL_MASK];
+        while (NULL != (*pptTimer)) {
+            CLASS(soft_timer_t) *ptThis = (*pptTimer);
+            if ((int32_t)(this.wExpire - s_wDone) > 0) {
+                //! expires in a later round
+                pptTimer = &(this.ptNext);
+                continue;
+            }
+            timer_unlink(ptThis);
+            timer_link(&s_ptExpired, ptThis);
+        }
+
+        while (NULL != s_ptExpired) {
+            CLASS(soft_timer_t) *ptThis = s_ptExpired;
+            fsm_rt_t tFSM;
+            timer_unlink(ptThis);
+
+            tFSM = call_delegate_handler(this.ptHandler, ptThis);
+            if ((0 == this.wPeriod) || (NULL != this.pptPrev)) {
+                //! one-shot, or restarted by the handler
+                continue;
+            } else if (EVENT_RT_UNREGISTER == tFSM) {
+                continue;
+            }
+            this.wExpire += this.wPeriod;
+            if ((int32_t)(this.wExpire - s_wDone) <= 0) {
+                //! too late, skip the missed periods
+                this.wExpire = s_wDone + this.wPeriod;
+            }
+            timer_link(&s_ptSlot[this.wExpire & TIMER_WHEEL_MASK], ptThis);
+        }
+    }
+
+    return fsm_rt_cpl;
+}
+
+/*! \brief get the ticks before the next timer expires, e.g. to sleep
+ *! \return the ticks, 0 for expired timers waiting for timer_wheel_run(),
+ *!         0xFFFFFFFF for no running timer
+ */
+uint32_t timer_wheel_get_next_expiry(void)
+{
+    uint32_t wNow = timer_wheel_get_tick();
+    uint32_t wNearest = 0xFFFFFFFF;
+    uint_fast16_t n;
+
+    if (s_wDone != wNow) {
+        //! the elapsed ticks are not handled yet
+        return 0;
+    }
+
+    //! the first slot with a timer of this round is the nearest one
+    for (n = 1; n <= TIMER_WHEEL_SIZE; n++) {
+        CLASS(soft_timer_t) *ptThis = s_ptSlot[(wNow + n) & TIMER_WHEEL_MASK];
+        for (; NULL != ptThis; ptThis = this.ptNext) {
+            uint32_t wLeft = this.wExpire - wNow;
+            if (wLeft == n) {
+                return n;
+            }
+            wNearest = MIN(wNearest, wLeft);
+        }
+    }
+
+    return wNearest;
+}
+
+/*! \brief initialize a software timer
+ *! \param ptTimer timer object
+ *! \param ptHandler handler called on expiry with the timer as parameter, 
+ *!        a periodic timer stops when it returns EVENT_RT_UNREGISTER
+ *! \return the timer object, NULL for invalid parameter
+ */
+soft_timer_t *soft_timer_init(soft_timer_t *ptTimer, DELEGATE_HANDLE *ptHandler)
+{
+    CLASS(soft_timer_t) *ptThis = (CLASS(soft_timer_t) *)ptTimer;
+    if (NULL == ptTimer || NULL == ptHandler) {
+        return NULL;
+    }
+
+    this.ptNext = NULL;
+    this.pptPrev = NULL;
+    this.wExpire = 0;
+    this.wPeriod = 0;
+    this.ptHandler = ptHandler;
+
+    return ptTimer;
+}
+
+/*! \brief start or restart a software timer, not for ISRs
+ *! \param ptTimer timer object
+ *! \param wTicks ticks before it expires, at least 1
+ *! \param wPeriod ticks between the following expiries, 0 for one-shot
+ *! \retval true the timer is started
+ *! \retval false invalid parameter
+ */
+bool soft_timer_start(soft_timer_t *ptTimer, uint32_t wTicks, uint32_t wPeriod)
+{
+    CLASS(soft_timer_t) *ptThis = (CLASS(soft_timer_t) *)ptTimer;
+    if (NULL == ptTimer || NULL == this.ptHandler) {
+        return false;
+    }
+
+    if (NULL != this.pptPrev) {
+        timer_unlink(ptThis);
+    }
+    this.wPeriod = wPeriod;
+    //! the isr tick is never behind the last handled one
+    this.wExpire = s_wTick + MAX(wTicks, 1);
+    timer_link(&s_ptSlot[this.wExpire & TIMER_WHEEL_MASK], ptThis);
+
+    return true;
+}
+
+/*! \brief stop a software timer, not for ISRs
+ *! \param ptTimer timer object
+ *! \return none
+ */
+void soft_timer_cancel(soft_timer_t *ptTimer)
+{
+    CLASS(soft_timer_t) *ptThis = (CLASS(soft_timer_t) *)ptTimer;
+    if (NULL == ptTimer) {
+        return ;
+    }
+
+    if (NULL != this.pptPrev) {
+        timer_unlink(ptThis);
+    }
+    //! a periodic timer cancelled by its own handler is not reloaded
+    this.wPeriod = 0;
+}
+
+/*! \brief check whether a software timer is running
+ *! \param ptTimer timer object
+ *! \retval true it is waiting for expiry
+ *! \retval false it is stopped
+ */
+bool soft_timer_is_running(soft_timer_t *ptTimer)
+{
+    CLASS(soft_timer_t) *ptThis = (CLASS(soft_timer_t) *)ptTimer;
+    if (NULL == ptTimer) {
+        return false;
+    }
+
+    return NULL != this.pptPrev;
+}
+
+/* EOF */
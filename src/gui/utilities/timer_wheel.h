@@ -0,0 +1,109 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __UTILITIES_TIMER_WHEEL_H__
+#define __UTILITIES_TIMER_WHEEL_H__
+
+/*============================ INCLUDES ======================================*/
+/*============================ MACROS ========================================*/
+
+//! \brief number of wheel slots, a power of two
+#ifndef TIMER_WHEEL_SIZE
+#   define TIMER_WHEEL_SIZE             32
+#endif
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+
+//! \name software timer
+//! @{
+EXTERN_CLASS(soft_timer_t)
+    soft_timer_t            *ptNext;
+    soft_timer_t            **pptPrev;
+    uint32_t                wExpire;
+    uint32_t                wPeriod;
+    DELEGATE_HANDLE         *ptHandler;
+END_EXTERN_CLASS(soft_timer_t)
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+/*! \brief initialize the timer wheel
+ *! \return none
+ */
+extern void timer_wheel_init(void);
+
+/*! \brief advance the time of the wheel, call it in the tick interrupt. It
+ *!        is the time of the scheduler too
+ *! \return none
+ */
+extern void timer_wheel_tick(void);
+
+/*! \brief get the ticks counted since timer_wheel_init()
+ *! \return the ticks, it wraps around
+ */
+extern uint32_t timer_wheel_get_tick(void);
+
+/*! \brief fire the expired timers, call it in the main loop or a task
+ *! \return fsm_rt_cpl all elapsed ticks are handled
+ */
+extern fsm_rt_t timer_wheel_run(void);
+
+/*! \brief get the ticks before the next timer expires, e.g. to sleep
+ *! \return the ticks, 0 for expired timers waiting for timer_wheel_run(),
+ *!         0xFFFFFFFF for no running timer
+ */
+extern uint32_t timer_wheel_get_next_expiry(void);
+
+/*! \brief initialize a software timer
+ *! \param ptTimer timer object
+ *! \param ptHandler handler called on expiry with the timer as parameter, 
+ *!        a periodic timer stops when it returns EVENT_RT_UNREGISTER
+ *! \return the timer object, NULL for invalid parameter
+ */
+extern soft_timer_t *soft_timer_init(
+    soft_timer_t *ptTimer, DELEGATE_HANDLE *ptHandler);
+
+/*! \brief start or restart a software timer, not for ISRs
+ *! \param ptTimer timer object
+ *! \param wTicks ticks before it expires, at least 1
+ *! \param wPeriod ticks between the following expiries, 0 for one-shot
+ *! \retval true the timer is started
+ *! \retval false invalid parameter
+ */
+extern bool soft_timer_start(
+    soft_timer_t *ptTimer, uint32_t wTicks, uint32_t wPeriod);
+
+/*! \brief stop a software timer, not for ISRs
+ *! \param ptTimer timer object
+ *! \return none
+ */
+extern void soft_timer_cancel(soft_timer_t *ptTimer);
+
+/*! \brief check whether a software timer is running
+ *! \param ptTimer timer object
+ *! \retval true it is waiting for expiry
+ *! \retval false it is stopped
+ */
+extern bool soft_timer_is_running(soft_timer_t *ptTimer);
+
+#endif
+/* EOF */
@@ -118,6 +118,21 @@ int main(void)
 
     return 0;
 }
+
+           The same FSM could also run in instance contexts provided by the
+           caller, e.g. one per channel, and be stepped in an array.
+
+DEF_TINY_FSM_CONTEXT(Print_String)
+
+static TINY_FSM_CONTEXT(Print_String) s_tChannel[4];
+
+    TINY_FSM_START(Print_String, &s_tChannel[0], Print_Init, chDemoA);
+    TINY_FSM_START(Print_String, &s_tChannel[1], Print_Init, chDemoB);
+    ...
+    while(true) {
+        //! step every instance once, it returns the number still running
+        TINY_FSM_DISPATCH(Print_String, s_tChannel, UBOUND(s_tChannel));
+    }
  */
 
 #define DEF_TINY_FSM(__NAME)  \
@@ -172,7 +187,67 @@ int main(void)
         *s_ptTinyFSMTemp = (tiny_fsm_##__NAME##_task)(*s_ptTinyFSMTemp)( &tParam );\
     } while(false);
 
-    
+
+
+/*! \brief define the instance context of a tiny fsm, place it after
+ *!        END_DEF_TINY_FSM. The context keeps the current state and the
+ *!        parameters, so the fsm could have any number of instances.
+ */
+#define DEF_TINY_FSM_CONTEXT(__NAME)                                        \
+    typedef struct {                                                        \
+        tiny_fsm_##__NAME##_task    fnState;                                \
+        tiny_fsm_##__NAME##_arg_t   tParam;                                 \
+    } tiny_fsm_##__NAME##_ctx_t;                                            \
+                                                                            \
+    static IN_LINE fsm_rt_t tiny_fsm_##__NAME##_step(                       \
+        tiny_fsm_##__NAME##_ctx_t *ptCtx)                                   \
+    {                                                                       \
+        if (NULL == ptCtx->fnState) {                                       \
+            return fsm_rt_cpl;                                              \
+        }                                                                   \
+        ptCtx->fnState =                                                    \
+            (tiny_fsm_##__NAME##_task)ptCtx->fnState(&(ptCtx->tParam));     \
+        return (NULL == ptCtx->fnState) ? fsm_rt_cpl : fsm_rt_on_going;     \
+    }                                                                       \
+                                                                            \
+    static IN_LINE uint_fast16_t tiny_fsm_##__NAME##_dispatch(              \
+        tiny_fsm_##__NAME##_ctx_t *ptCtx, uint_fast16_t hwCount)            \
+    {                                                                       \
+        uint_fast16_t hwRunning = 0;                                        \
+        for (; hwCount; hwCount--, ptCtx++) {                               \
+            if (NULL == ptCtx->fnState) {                                   \
+                continue;                                                   \
+            }                                                               \
+            ptCtx->fnState =                                                \
+                (tiny_fsm_##__NAME##_task)ptCtx->fnState(&(ptCtx->tParam)); \
+            if (NULL != ptCtx->fnState) {                                   \
+                hwRunning++;                                                \
+            }                                                               \
+        }                                                                   \
+        return hwRunning;                                                   \
+    }
+
+#define TINY_FSM_CONTEXT(__NAME)    tiny_fsm_##__NAME##_ctx_t
+
+/*! \brief (re)start an instance from the specified state, the rest are the
+ *!        initial values of the parameters, at least one.
+ */
+#define TINY_FSM_START(__NAME, __CTX, __START_STATE, ...)   do {\
+        (__CTX)->tParam = (tiny_fsm_##__NAME##_arg_t){__VA_ARGS__};\
+        (__CTX)->fnState = &(tiny_fsm_state_##__START_STATE);\
+    } while(false)
+
+//! \brief run one state of an instance, it returns fsm_rt_cpl when complete
+#define TINY_FSM_STEP(__NAME, __CTX)                                        \
+            tiny_fsm_##__NAME##_step(__CTX)
+
+//! \brief run one state of every instance in an array, it returns the number
+//!        of instances still running
+#define TINY_FSM_DISPATCH(__NAME, __ARRAY, __COUNT)                         \
+            tiny_fsm_##__NAME##_dispatch((__ARRAY), (__COUNT))
+
+#define IS_TINY_FSM_CONTEXT_CPL(__CTX)      (NULL == (__CTX)->fnState)
+
 
 /*============================ TYPES =========================================*/
 /*============================ GLOBAL VARIABLES ==============================*/
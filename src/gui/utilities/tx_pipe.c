@@ -0,0 +1,357 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+/*============================ INCLUDES ======================================*/
+#ifndef __STORE_ENVIRONMENT_CFG_IN_PROJ__
+#include "..\..\environment_cfg.h"
+#endif
+
+#include ".\compiler.h"
+#include ".\communicate.h"
+#include ".\tx_pipe.h"
+
+#if defined(__CPU_HOST__)
+#include <unistd.h>
+#endif
+
+/*============================ MACROS ========================================*/
+
+#define this             (*ptThis)
+
+/*============================ MACROFIED FUNCTIONS ===========================*/
+/*============================ TYPES =========================================*/
+
+//! \name tx pipe
+//! @{
+//! \note bytes in [hwTail, hwHead) are waiting, when the writer has wrapped 
+//!       (hwHead < hwTail) they are [hwTail, hwEnd) and [0, hwHead)
+typedef struct __tx_pipe CLASS(tx_pipe_t);
+struct __tx_pipe {
+    uint8_t                 *pchBuffer;     //!< ring buffer
+    uint16_t                hwSize;         //!< buffer size
+    volatile uint16_t       hwHead;         //!< next byte to write
+    volatile uint16_t       hwTail;         //!< next byte to send
+    volatile uint16_t       hwEnd;          //!< end of data before wrapping
+    volatile uint16_t       hwSending;      //!< size of the block being sent
+    tx_pipe_start_t         *fnStart;       //!< driver routine
+    void                    *pTarget;       //!< driver object
+};
+//! @}
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+/*============================ IMPLEMENTATION ================================*/
+
+/*! \brief hand the next contiguous block to the driver when it is idle
+ *! \param ptThis pipe object
+ *! \return none
+ */
+static void pipe_kick(CLASS(tx_pipe_t) *ptThis)
+{
+    uint_fast16_t hwTail = 0;
+    uint_fast16_t hwSize = 0;
+
+    SAFE_ATOM_CODE(
+        if (0 == this.hwSending) {
+            if ((this.hwHead < this.hwTail) && (this.hwTail == this.hwEnd)) {
+                //! the end is sent, the writer continues from the beginning
+                this.hwTail = 0;
+                this.hwEnd = this.hwSize;
+            }
+            hwTail = this.hwTail;
+            if (this.hwHead >= hwTail) {
+                hwSize = this.hwHead - hwTail;
+            } else {
+                hwSize = this.hwEnd - hwTail;
+            }
+            this.hwSending = hwSize;
+        }
+    )
+
+    if (0 == hwSize) {
+        return ;
+    }
+    if (!this.fnStart(this.pTarget, &this.pchBuffer[hwTail], hwSize)) {
+        //! driver refused, try again later
+        this.hwSending = 0;
+    }
+}
+
+/*! \brief initialize a tx pipe
+ *! \param ptPipe pipe object
+ *! \param pchBuffer ring buffer
+ *! \param hwSize buffer size, one byte is never used
+ *! \param fnStart driver routine starting a transmission
+ *! \param pTarget driver object passed to fnStart
+ *! \retval true pipe is initialized
+ *! \retval false invalid parameter
+ */
+bool tx_pipe_init(tx_pipe_t *ptPipe, uint8_t *pchBuffer, 
+    uint_fast16_t hwSize, tx_pipe_start_t *fnStart, void *pTarget)
+{
+    CLASS(tx_pipe_t) *ptThis = (CLASS(tx_pipe_t) *)ptPipe;
+
+    if (    (NULL == ptPipe) || (NULL == pchBuffer) || (NULL == fnStart)
+        ||  (hwSize < 2) || (hwSize > 0xFFFF)) {
+        return false;
+    }
+
+    this.pchBuffer = pchBuffer;
+    this.hwSize = hwSize;
+    this.hwHead = 0;
+    this.hwTail = 0;
+    this.hwEnd = hwSize;
+    this.hwSending = 0;
+    this.fnStart = fnStart;
+    this.pTarget = pTarget;
+
+    return true;
+}
+
+/*! \brief reserve a contiguous span in the ring, an encoder writes into it
+ *!        directly and publishes what it has written with tx_pipe_commit().
+ *!        A span can be dropped, it is valid until the next reservation.
+ *! \param ptPipe pipe object
+ *! \param hwSize minimum span size
+ *! \param phwSpan returns the whole span size available, NULL for not used
+ *! \return the span, NULL for not enough contiguous space now
+ */
+uint8_t *tx_pipe_reserve(
+    tx_pipe_t *ptPipe, uint_fast16_t hwSize, uint_fast16_t *phwSpan)
+{
+    CLASS(tx_pipe_t) *ptThis = (CLASS(tx_pipe_t) *)ptPipe;
+    uint_fast16_t hwHead, hwTail, hwOffset, hwSpan;
+
+    if ((NULL == ptPipe) || (0 == hwSize)) {
+        return NULL;
+    }
+
+    SAFE_ATOM_CODE(
+        if ((this.hwHead == this.hwTail) && (0 == this.hwSending)) {
+            //! empty, start from the beginning for the largest span
+            this.hwHead = 0;
+            this.hwTail = 0;
+            this.hwEnd = this.hwSize;
+        }
+        hwHead = this.hwHead;
+        hwTail = this.hwTail;
+    )
+
+    if (hwHead < hwTail) {
+        //! wrapped, the head never catches up the tail
+        hwOffset = hwHead;
+        hwSpan = hwTail - hwHead - 1;
+    } else if ((this.hwSize - hwHead >= hwSize) || (hwTail <= hwSize)) {
+        //! wrapping does not give a larger span
+        hwOffset = hwHead;
+        hwSpan = this.hwSize - hwHead;
+    } else {
+        //! the span starts from the beginning, the end is left unused
+        hwOffset = 0;
+        hwSpan = hwTail - 1;
+    }
+
+    if (hwSpan < hwSize) {
+        return NULL;
+    }
+    if (NULL != phwSpan) {
+        *phwSpan = hwSpan;
+    }
+
+    return &this.pchBuffer[hwOffset];
+}
+
+/*! \brief publish bytes written into a reserved span and start transmission
+ *! \param ptPipe pipe object
+ *! \param pchSpan span returned by the last tx_pipe_reserve()
+ *! \param hwSize number of bytes written at the beginning of the span
+ *! \return none
+ */
+void tx_pipe_commit(tx_pipe_t *ptPipe, uint8_t *pchSpan, uint_fast16_t hwSize)
+{
+    CLASS(tx_pipe_t) *ptThis = (CLASS(tx_pipe_t) *)ptPipe;
+    uint_fast16_t hwOffset;
+
+    if ((NULL == ptPipe) || (NULL == pchSpan)) {
+        return ;
+    }
+
+    if (0 != hwSize) {
+        hwOffset = pchSpan - this.pchBuffer;
+        SAFE_ATOM_CODE(
+            if (hwOffset != this.hwHead) {
+                //! the span is at the beginning, mark where the data ends
+                this.hwEnd = this.hwHead;
+            }
+            this.hwHead = hwOffset + hwSize;
+        )
+    }
+
+    pipe_kick(ptThis);
+}
+
+/*! \brief copy bytes into the pipe
+ *! \param ptPipe pipe object
+ *! \param pchStream bytes to write
+ *! \param hwSize number of bytes
+ *! \return the number of bytes accepted
+ */
+uint_fast16_t tx_pipe_write(
+    tx_pipe_t *ptPipe, const uint8_t *pchStream, uint_fast16_t hwSize)
+{
+    uint_fast16_t hwWritten = 0;
+
+    if (NULL == pchStream) {
+        return 0;
+    }
+
+    //! two spans at most, the end of the buffer and the beginning
+    while (hwWritten < hwSize) {
+        uint_fast16_t hwSpan, hwCount;
+        uint8_t *pchSpan = tx_pipe_reserve(ptPipe, 1, &hwSpan);
+        if (NULL == pchSpan) {
+            break;
+        }
+
+        hwSpan = MIN(hwSpan, hwSize - hwWritten);
+        for (hwCount = 0; hwCount < hwSpan; hwCount++) {
+            pchSpan[hwCount] = *pchStream++;
+        }
+        tx_pipe_commit(ptPipe, pchSpan, hwSpan);
+        hwWritten += hwSpan;
+    }
+
+    return hwWritten;
+}
+
+/*! \brief write a byte into the pipe
+ *! \param ptPipe pipe object
+ *! \param chByte byte to write
+ *! \retval true the byte is accepted
+ *! \retval false the pipe is full
+ */
+bool tx_pipe_write_byte(tx_pipe_t *ptPipe, uint_fast8_t chByte)
+{
+    uint8_t *pchSpan = tx_pipe_reserve(ptPipe, 1, NULL);
+
+    if (NULL == pchSpan) {
+        return false;
+    }
+    *pchSpan = chByte;
+    tx_pipe_commit(ptPipe, pchSpan, 1);
+
+    return true;
+}
+
+/*! \brief check whether everything written is sent
+ *! \param ptPipe pipe object
+ *! \retval true the pipe is empty and the driver is idle
+ *! \retval false transmission on going
+ */
+bool tx_pipe_is_idle(tx_pipe_t *ptPipe)
+{
+    CLASS(tx_pipe_t) *ptThis = (CLASS(tx_pipe_t) *)ptPipe;
+    bool bResult;
+
+    if (NULL == ptPipe) {
+        return true;
+    }
+
+    //! a block refused by the driver is retried here
+    pipe_kick(ptThis);
+    SAFE_ATOM_CODE(
+        bResult = (this.hwHead == this.hwTail) && (0 == this.hwSending);
+    )
+
+    return bResult;
+}
+
+/*! \brief transmission complete, call it from the DMA or TX interrupt when
+ *!        the block passed to fnStart is sent
+ *! \param ptPipe pipe object
+ *! \return none
+ */
+void tx_pipe_tx_cpl(tx_pipe_t *ptPipe)
+{
+    CLASS(tx_pipe_t) *ptThis = (CLASS(tx_pipe_t) *)ptPipe;
+
+    if (NULL == ptPipe) {
+        return ;
+    }
+
+    SAFE_ATOM_CODE(
+        this.hwTail += this.hwSending;
+        this.hwSending = 0;
+    )
+    //! bytes written meanwhile go out at once
+    pipe_kick(ptThis);
+}
+
+#if defined(__CPU_HOST__)
+/*! \brief tx_pipe_start_t of the host stand-in, pTarget is a tx_pipe_host_t
+ */
+bool tx_pipe_host_start(
+    void *pTarget, const uint8_t *pchBlock, uint_fast16_t hwSize)
+{
+    tx_pipe_host_t *ptHost = (tx_pipe_host_t *)pTarget;
+
+    if ((NULL == ptHost) || (NULL != ptHost->pchBlock)) {
+        return false;
+    }
+    ptHost->pchBlock = pchBlock;
+    ptHost->hwSize = hwSize;
+
+    return true;
+}
+
+/*! \brief play the transmit complete interrupt of the host stand-in, the
+ *!        pending block is written to the file
+ *! \param ptHost host driver object
+ *! \retval true a block is sent
+ *! \retval false nothing to send
+ */
+bool tx_pipe_host_isr(tx_pipe_host_t *ptHost)
+{
+    const uint8_t *pchBlock;
+    uint_fast16_t hwSize;
+
+    if ((NULL == ptHost) || (NULL == ptHost->pchBlock)) {
+        return false;
+    }
+    pchBlock = ptHost->pchBlock;
+    hwSize = ptHost->hwSize;
+    ptHost->pchBlock = NULL;
+
+    while (0 != hwSize) {
+        ssize_t nWritten = write(ptHost->iFile, pchBlock, hwSize);
+        if (nWritten <= 0) {
+            break;
+        }
+        pchBlock += nWritten;
+        hwSize -= nWritten;
+    }
+    tx_pipe_tx_cpl(ptHost->ptPipe);
+
+    return true;
+}
+#endif
+
+/* EOF */
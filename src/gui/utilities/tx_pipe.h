@@ -0,0 +1,179 @@
+/***************************************************************************
+ *   Copyright(C)2009-2012 by Gorgon Meducer<Embedded_zhuoran@hotmail.com> *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __UTILITIES_TX_PIPE_H__
+#define __UTILITIES_TX_PIPE_H__
+
+/*============================ INCLUDES ======================================*/
+/*============================ MACROS ========================================*/
+/*============================ MACROFIED FUNCTIONS ===========================*/
+
+/*! \brief implement i_pipe_t with a tx pipe object, the pipe only transmits
+ *! \param __NAME name of the i_pipe_t object
+ *! \param __PIPE tx_pipe_t object
+ */
+#define DEF_TX_PIPE_INTERFACE(__NAME, __PIPE)                               \
+static bool __NAME##_read_byte(uint8_t *pchByte)                            \
+{                                                                           \
+    return false;                                                           \
+}                                                                           \
+static bool __NAME##_write_byte(uint_fast8_t chByte)                        \
+{                                                                           \
+    return tx_pipe_write_byte(&(__PIPE), chByte);                           \
+}                                                                           \
+static uint_fast16_t __NAME##_read_stream(                                  \
+    uint8_t *pchStream, uint_fast16_t hwSize)                               \
+{                                                                           \
+    return 0;                                                               \
+}                                                                           \
+static uint_fast16_t __NAME##_write_stream(                                 \
+    uint8_t *pchStream, uint_fast16_t hwSize)                               \
+{                                                                           \
+    return tx_pipe_write(&(__PIPE), pchStream, hwSize);                     \
+}                                                                           \
+const i_pipe_t __NAME = {                                                   \
+    .ReadByte = &__NAME##_read_byte,                                        \
+    .WriteByte = &__NAME##_write_byte,                                      \
+    .ReadStream = &__NAME##_read_stream,                                    \
+    .WriteStream = &__NAME##_write_stream,                                  \
+};
+
+/*============================ TYPES =========================================*/
+
+/*! \brief start transmitting a block by DMA or TX empty interrupt, the driver
+ *!        calls tx_pipe_tx_cpl() when the whole block is sent
+ *! \param pTarget driver object
+ *! \param pchBlock block to send, it stays valid until tx_pipe_tx_cpl()
+ *! \param hwSize block size
+ *! \retval true transmission is started
+ *! \retval false the driver is not ready, the pipe tries again later
+ */
+typedef bool tx_pipe_start_t(
+    void *pTarget, const uint8_t *pchBlock, uint_fast16_t hwSize);
+
+//! \name tx pipe, a ring buffer transmitted in contiguous blocks
+//! @{
+EXTERN_CLASS(tx_pipe_t)
+    uint8_t                 *pchBuffer;
+    uint16_t                hwSize;
+    volatile uint16_t       hwHead;
+    volatile uint16_t       hwTail;
+    volatile uint16_t       hwEnd;
+    volatile uint16_t       hwSending;
+    tx_pipe_start_t         *fnStart;
+    void                    *pTarget;
+END_EXTERN_CLASS(tx_pipe_t)
+//! @}
+
+#if defined(__CPU_HOST__)
+//! \name host stand-in of a tx driver, it drains the pipe to a file
+//! @{
+typedef struct {
+    int                     iFile;          //!< file descriptor
+    tx_pipe_t               *ptPipe;        //!< pipe to report completion to
+    const uint8_t           *pchBlock;      //!< block in transmission
+    uint_fast16_t           hwSize;         //!< block size
+} tx_pipe_host_t;
+//! @}
+#endif
+
+/*============================ GLOBAL VARIABLES ==============================*/
+/*============================ LOCAL VARIABLES ===============================*/
+/*============================ PROTOTYPES ====================================*/
+
+/*! \brief initialize a tx pipe
+ *! \param ptPipe pipe object
+ *! \param pchBuffer ring buffer
+ *! \param hwSize buffer size, one byte is never used
+ *! \param fnStart driver routine starting a transmission
+ *! \param pTarget driver object passed to fnStart
+ *! \retval true pipe is initialized
+ *! \retval false invalid parameter
+ */
+extern bool tx_pipe_init(tx_pipe_t *ptPipe, uint8_t *pchBuffer, 
+    uint_fast16_t hwSize, tx_pipe_start_t *fnStart, void *pTarget);
+
+/*! \brief reserve a contiguous span in the ring, an encoder writes into it
+ *!        directly and publishes what it has written with tx_pipe_commit().
+ *!        A span can be dropped, it is valid until the next reservation.
+ *! \param ptPipe pipe object
+ *! \param hwSize minimum span size
+ *! \param phwSpan returns the whole span size available, NULL for not used
+ *! \return the span, NULL for not enough contiguous space now
+ */
+extern uint8_t *tx_pipe_reserve(
+    tx_pipe_t *ptPipe, uint_fast16_t hwSize, uint_fast16_t *phwSpan);
+
+/*! \brief publish bytes written into a reserved span and start transmission
+ *! \param ptPipe pipe object
+ *! \param pchSpan span returned by the last tx_pipe_reserve()
+ *! \param hwSize number of bytes written at the beginning of the span
+ *! \return none
+ */
+extern void tx_pipe_commit(
+    tx_pipe_t *ptPipe, uint8_t *pchSpan, uint_fast16_t hwSize);
+
+/*! \brief copy bytes into the pipe
+ *! \param ptPipe pipe object
+ *! \param pchStream bytes to write
+ *! \param hwSize number of bytes
+ *! \return the number of bytes accepted
+ */
+extern uint_fast16_t tx_pipe_write(
+    tx_pipe_t *ptPipe, const uint8_t *pchStream, uint_fast16_t hwSize);
+
+/*! \brief write a byte into the pipe
+ *! \param ptPipe pipe object
+ *! \param chByte byte to write
+ *! \retval true the byte is accepted
+ *! \retval false the pipe is full
+ */
+extern bool tx_pipe_write_byte(tx_pipe_t *ptPipe, uint_fast8_t chByte);
+
+/*! \brief check whether everything written is sent
+ *! \param ptPipe pipe object
+ *! \retval true the pipe is empty and the driver is idle
+ *! \retval false transmission on going
+ */
+extern bool tx_pipe_is_idle(tx_pipe_t *ptPipe);
+
+/*! \brief transmission complete, call it from the DMA or TX interrupt when
+ *!        the block passed to fnStart is sent
+ *! \param ptPipe pipe object
+ *! \return none
+ */
+extern void tx_pipe_tx_cpl(tx_pipe_t *ptPipe);
+
+#if defined(__CPU_HOST__)
+/*! \brief tx_pipe_start_t of the host stand-in, pTarget is a tx_pipe_host_t
+ */
+extern bool tx_pipe_host_start(
+    void *pTarget, const uint8_t *pchBlock, uint_fast16_t hwSize);
+
+/*! \brief play the transmit complete interrupt of the host stand-in, the
+ *!        pending block is written to the file
+ *! \param ptHost host driver object
+ *! \retval true a block is sent
+ *! \retval false nothing to send
+ */
+extern bool tx_pipe_host_isr(tx_pipe_host_t *ptHost);
+#endif
+
+#endif
+/* EOF */